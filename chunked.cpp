@@ -0,0 +1,432 @@
+//
+// Created by dewe on 10/17/26.
+//
+#include "chunked.h"
+#include <arrow/compute/api.h>
+#include "io.h"
+
+
+namespace pd {
+
+static int64_t chunkLength(std::shared_ptr<arrow::Array> const& chunk)
+{
+    return chunk->length();
+}
+
+static int64_t chunkLength(std::shared_ptr<arrow::RecordBatch> const& chunk)
+{
+    return chunk->num_rows();
+}
+
+/// the parts of chunks covering [offset, offset + length), sliced zero-copy
+template<class ChunkT>
+static std::vector<ChunkT> sliceChunks(
+    std::vector<ChunkT> const& chunks,
+    int64_t offset,
+    int64_t length)
+{
+    std::vector<ChunkT> result;
+    for (auto const& chunk : chunks)
+    {
+        if (length <= 0)
+        {
+            break;
+        }
+
+        auto n = chunkLength(chunk);
+        if (offset >= n)
+        {
+            offset -= n;
+            continue;
+        }
+
+        auto take = std::min(n - offset, length);
+        result.push_back(
+            offset == 0 and take == n ? chunk : chunk->Slice(offset, take));
+        length -= take;
+        offset = 0;
+    }
+    return result;
+}
+
+/// index chunks laid out like chunks, reusing the existing ones when the
+/// boundaries already match. An empty chunk gets an empty index of type
+template<class ChunkT>
+static arrow::ArrayVector alignIndex(
+    arrow::ArrayVector const& index,
+    std::vector<ChunkT> const& chunks,
+    std::shared_ptr<arrow::DataType> const& type)
+{
+    arrow::ArrayVector result;
+    result.reserve(chunks.size());
+
+    int64_t offset = 0;
+    for (auto const& chunk : chunks)
+    {
+        auto n = chunkLength(chunk);
+        auto parts = sliceChunks(index, offset, n);
+        if (parts.empty())
+        {
+            result.push_back(
+                index.empty() ? ReturnOrThrowOnFailure(arrow::MakeEmptyArray(type)) :
+                                index.front()->Slice(0, 0));
+        }
+        else
+        {
+            result.push_back(
+                parts.size() == 1 ? parts[0] :
+                                    ReturnOrThrowOnFailure(arrow::Concatenate(parts)));
+        }
+        offset += n;
+    }
+    return result;
+}
+
+ChunkedSeries::ChunkedSeries(
+    std::shared_ptr<arrow::ChunkedArray> const& array,
+    std::shared_ptr<arrow::ChunkedArray> const& index,
+    std::string name)
+    : m_chunks(array->chunks()),
+      m_type(array->type()),
+      m_name(std::move(name)),
+      m_size(array->length())
+{
+    arrow::ArrayVector indexChunks = index ?
+        index->chunks() :
+        arrow::ArrayVector{ range(uint64_t{ 0 }, static_cast<uint64_t>(m_size)) };
+    if (index and index->length() != m_size)
+    {
+        throw std::runtime_error("index and values must have the same length");
+    }
+    m_indexChunks = alignIndex(
+        indexChunks, m_chunks, index ? index->type() : arrow::uint64());
+}
+
+ChunkedSeries::ChunkedSeries(Series const& series)
+    : m_chunks{ series.array() },
+      m_indexChunks{ series.indexArray() },
+      m_type(series.dtype()),
+      m_name(series.name()),
+      m_size(series.size())
+{
+}
+
+void ChunkedSeries::append(Series const& series)
+{
+    if (m_type and not m_type->Equals(series.dtype()))
+    {
+        throw std::runtime_error(
+            "cannot append " + series.dtype()->ToString() + " to " +
+            m_type->ToString());
+    }
+    if (not m_indexChunks.empty() and
+        not m_indexChunks.front()->type()->Equals(series.indexArray()->type()))
+    {
+        throw std::runtime_error(
+            "cannot append a Series with a different index type");
+    }
+    m_type = series.dtype();
+    m_chunks.push_back(series.array());
+    m_indexChunks.push_back(series.indexArray());
+    m_size += series.size();
+}
+
+void ChunkedSeries::append(ChunkedSeries const& series)
+{
+    for (int i = 0; i < series.num_chunks(); i++)
+    {
+        append(series.chunk(i));
+    }
+}
+
+std::shared_ptr<arrow::ChunkedArray> ChunkedSeries::array() const
+{
+    return std::make_shared<arrow::ChunkedArray>(m_chunks, m_type);
+}
+
+std::shared_ptr<arrow::ChunkedArray> ChunkedSeries::index() const
+{
+    if (m_indexChunks.empty())
+    {
+        return std::make_shared<arrow::ChunkedArray>(
+            m_indexChunks, arrow::uint64());
+    }
+    return std::make_shared<arrow::ChunkedArray>(m_indexChunks);
+}
+
+Series ChunkedSeries::chunk(int i) const
+{
+    return { m_chunks.at(i), m_indexChunks.at(i), m_name };
+}
+
+ChunkedSeries ChunkedSeries::slice(int64_t offset, int64_t length) const
+{
+    ChunkedSeries result;
+    result.m_type = m_type;
+    result.m_name = m_name;
+    result.m_chunks = sliceChunks(m_chunks, offset, length);
+    result.m_indexChunks = sliceChunks(m_indexChunks, offset, length);
+    for (auto const& chunk : result.m_chunks)
+    {
+        result.m_size += chunk->length();
+    }
+    return result;
+}
+
+Series ChunkedSeries::combine() const
+{
+    if (m_chunks.empty())
+    {
+        throw std::runtime_error("Cannot combine an empty ChunkedSeries");
+    }
+    if (m_chunks.size() == 1)
+    {
+        return chunk(0);
+    }
+    return { ReturnOrThrowOnFailure(arrow::Concatenate(m_chunks)),
+             ReturnOrThrowOnFailure(arrow::Concatenate(m_indexChunks)),
+             m_name };
+}
+
+ChunkedSeries ChunkedSeries::apply(
+    std::function<Series(Series const&)> const& fn) const
+{
+    ChunkedSeries result;
+    result.m_name = m_name;
+    for (int i = 0; i < num_chunks(); i++)
+    {
+        result.append(fn(chunk(i)));
+    }
+    return result;
+}
+
+Scalar ChunkedSeries::agg(std::string const& func, bool skip_null) const
+{
+    arrow::compute::ScalarAggregateOptions opt{ skip_null };
+    auto result = arrow::compute::CallFunction(func, { array() }, &opt);
+    if (result.ok())
+    {
+        return result->scalar();
+    }
+    throw std::runtime_error(result.status().ToString());
+}
+
+Scalar ChunkedSeries::min() const
+{
+    return agg("min");
+}
+
+Scalar ChunkedSeries::max() const
+{
+    return agg("max");
+}
+
+Scalar ChunkedSeries::sum() const
+{
+    return agg("sum");
+}
+
+double ChunkedSeries::mean(bool skip_null) const
+{
+    return ReturnScalarOrThrowOnError<double>(arrow::compute::Mean(
+        array(),
+        arrow::compute::ScalarAggregateOptions{ skip_null }));
+}
+
+double ChunkedSeries::std(int ddof, bool skip_na) const
+{
+    return ReturnScalarOrThrowOnError<double>(arrow::compute::Stddev(
+        array(),
+        arrow::compute::VarianceOptions{ ddof, skip_na }));
+}
+
+double ChunkedSeries::var(int ddof, bool skip_na) const
+{
+    return ReturnScalarOrThrowOnError<double>(arrow::compute::Variance(
+        array(),
+        arrow::compute::VarianceOptions{ ddof, skip_na }));
+}
+
+int64_t ChunkedSeries::count() const
+{
+    return ReturnScalarOrThrowOnError<int64_t>(arrow::compute::Count(array()));
+}
+
+ChunkedSeries ChunkedSeries::binary(
+    std::string const& function,
+    arrow::Datum const& other) const
+{
+    auto result = ReturnOrThrowOnFailure(
+        arrow::compute::CallFunction(function, { array(), other }));
+
+    // chunk boundaries of both operands split the output, re-slice the index
+    auto chunks = result.chunked_array()->chunks();
+    ChunkedSeries series;
+    series.m_type = result.chunked_array()->type();
+    series.m_name = m_name;
+    series.m_size = m_size;
+    series.m_indexChunks = alignIndex(
+        m_indexChunks,
+        chunks,
+        m_indexChunks.empty() ? arrow::uint64() : m_indexChunks.front()->type());
+    series.m_chunks = std::move(chunks);
+    return series;
+}
+
+#define CHUNKED_BINARY_OPERATOR(sign, function)                               \
+    ChunkedSeries ChunkedSeries::operator sign(ChunkedSeries const& s) const  \
+    {                                                                         \
+        return binary(function, s.array());                                   \
+    }                                                                         \
+    ChunkedSeries ChunkedSeries::operator sign(Scalar const& s) const         \
+    {                                                                         \
+        return binary(function, s.value());                                   \
+    }
+
+CHUNKED_BINARY_OPERATOR(+, "add")
+CHUNKED_BINARY_OPERATOR(-, "subtract")
+CHUNKED_BINARY_OPERATOR(*, "multiply")
+CHUNKED_BINARY_OPERATOR(/, "divide")
+
+#undef CHUNKED_BINARY_OPERATOR
+
+ChunkedDataFrame::ChunkedDataFrame(DataFrame const& df)
+    : m_schema(df.m_array->schema()),
+      m_batches{ df.m_array },
+      m_indexChunks{ df.indexArray() },
+      m_numRows(df.num_rows())
+{
+}
+
+ChunkedDataFrame::ChunkedDataFrame(
+    std::shared_ptr<arrow::Table> const& table,
+    std::shared_ptr<arrow::ChunkedArray> const& index)
+    : m_schema(table->schema()), m_numRows(table->num_rows())
+{
+    // splits at the union of the column chunk boundaries, without copying
+    arrow::TableBatchReader reader(*table);
+    m_batches = ReturnOrThrowOnFailure(reader.ToRecordBatches());
+
+    arrow::ArrayVector indexChunks = index ?
+        index->chunks() :
+        arrow::ArrayVector{ range(uint64_t{ 0 }, static_cast<uint64_t>(m_numRows)) };
+    if (index and index->length() != m_numRows)
+    {
+        throw std::runtime_error("index and table must have the same length");
+    }
+    m_indexChunks = alignIndex(
+        indexChunks, m_batches, index ? index->type() : arrow::uint64());
+}
+
+void ChunkedDataFrame::append(DataFrame const& df)
+{
+    if (m_schema and not m_schema->Equals(*df.m_array->schema(), false))
+    {
+        throw std::runtime_error(
+            "cannot append a DataFrame with a different schema");
+    }
+    if (not m_indexChunks.empty() and
+        not m_indexChunks.front()->type()->Equals(df.indexArray()->type()))
+    {
+        throw std::runtime_error(
+            "cannot append a DataFrame with a different index type");
+    }
+
+    m_schema = df.m_array->schema();
+    m_batches.push_back(df.m_array);
+    m_indexChunks.push_back(df.indexArray());
+    m_numRows += df.num_rows();
+}
+
+void ChunkedDataFrame::append(ChunkedDataFrame const& df)
+{
+    for (int i = 0; i < df.num_chunks(); i++)
+    {
+        append(df.chunk(i));
+    }
+}
+
+ChunkedDataFrame ChunkedDataFrame::readParquet(
+    std::filesystem::path const& path,
+    ParquetReadOptions const& options)
+{
+    auto reader = DataFrame::readParquetBatches(path, options);
+
+    ChunkedDataFrame result;
+    while (auto batch = reader.next())
+    {
+        result.append(*batch);
+    }
+    return result;
+}
+
+std::vector<std::string> ChunkedDataFrame::columnNames() const
+{
+    return m_schema ? m_schema->field_names() : std::vector<std::string>{};
+}
+
+ChunkedSeries ChunkedDataFrame::operator[](std::string const& column) const
+{
+    auto i = m_schema ? m_schema->GetFieldIndex(column) : -1;
+    if (i == -1)
+    {
+        throw std::runtime_error(column + " is not in the columns");
+    }
+
+    ChunkedSeries result;
+    for (size_t j = 0; j < m_batches.size(); j++)
+    {
+        result.append(Series{ m_batches[j]->column(i), m_indexChunks[j], column });
+    }
+    return result;
+}
+
+DataFrame ChunkedDataFrame::chunk(int i) const
+{
+    return { m_batches.at(i), m_indexChunks.at(i) };
+}
+
+ChunkedDataFrame ChunkedDataFrame::slice(int64_t offset, int64_t length) const
+{
+    ChunkedDataFrame result;
+    result.m_schema = m_schema;
+    result.m_batches = sliceChunks(m_batches, offset, length);
+    result.m_indexChunks = sliceChunks(m_indexChunks, offset, length);
+    for (auto const& batch : result.m_batches)
+    {
+        result.m_numRows += batch->num_rows();
+    }
+    return result;
+}
+
+std::shared_ptr<arrow::Table> ChunkedDataFrame::table() const
+{
+    return ReturnOrThrowOnFailure(
+        arrow::Table::FromRecordBatches(m_schema, m_batches));
+}
+
+std::shared_ptr<arrow::ChunkedArray> ChunkedDataFrame::index() const
+{
+    if (m_indexChunks.empty())
+    {
+        return std::make_shared<arrow::ChunkedArray>(
+            m_indexChunks, arrow::uint64());
+    }
+    return std::make_shared<arrow::ChunkedArray>(m_indexChunks);
+}
+
+DataFrame ChunkedDataFrame::combine() const
+{
+    if (m_batches.empty())
+    {
+        throw std::runtime_error("Cannot combine an empty ChunkedDataFrame");
+    }
+    if (m_batches.size() == 1)
+    {
+        return chunk(0);
+    }
+    return { ReturnOrThrowOnFailure(table()->CombineChunksToBatch()),
+             ReturnOrThrowOnFailure(arrow::Concatenate(m_indexChunks)) };
+}
+
+}
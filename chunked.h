@@ -0,0 +1,174 @@
+#pragma once
+//
+// Created by dewe on 10/17/26.
+//
+
+#include "dataframe.h"
+#include "series.h"
+
+
+namespace pd {
+
+/// A Series stored as a list of arrow chunks with a matching list of index
+/// chunks. append adds a chunk instead of copying what is already stored,
+/// and reductions and element-wise operations run over the chunks directly.
+/// combine() compacts it into a regular Series when one is needed.
+class ChunkedSeries
+{
+public:
+    ChunkedSeries() = default;
+
+    ChunkedSeries(
+        std::shared_ptr<arrow::ChunkedArray> const& array,
+        std::shared_ptr<arrow::ChunkedArray> const& index = nullptr,
+        std::string name = "");
+
+    explicit ChunkedSeries(Series const& series);
+
+    /// O(1), the values of series are referenced, not copied
+    void append(Series const& series);
+    void append(ChunkedSeries const& series);
+
+    [[nodiscard]] std::shared_ptr<arrow::ChunkedArray> array() const;
+    [[nodiscard]] std::shared_ptr<arrow::ChunkedArray> index() const;
+
+    /// zero-copy view of the i-th chunk
+    [[nodiscard]] Series chunk(int i) const;
+
+    inline int num_chunks() const
+    {
+        return static_cast<int>(m_chunks.size());
+    }
+
+    inline int64_t size() const
+    {
+        return m_size;
+    }
+
+    inline bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    inline std::string name() const
+    {
+        return m_name;
+    }
+
+    inline std::shared_ptr<arrow::DataType> dtype() const
+    {
+        return m_type;
+    }
+
+    [[nodiscard]] ChunkedSeries slice(int64_t offset, int64_t length) const;
+
+    /// concatenates the chunks into one contiguous Series
+    [[nodiscard]] Series combine() const;
+
+    /// runs fn on every chunk, the results become the chunks of the output
+    [[nodiscard]] ChunkedSeries apply(
+        std::function<Series(Series const&)> const& fn) const;
+
+    // agg functions
+    [[nodiscard]] Scalar agg(std::string const& func, bool skip_null = true)
+        const;
+    [[nodiscard]] Scalar min() const;
+    [[nodiscard]] Scalar max() const;
+    [[nodiscard]] Scalar sum() const;
+    [[nodiscard]] double mean(bool skip_null = true) const;
+    [[nodiscard]] double std(int ddof = 1, bool skip_na = true) const;
+    [[nodiscard]] double var(int ddof = 1, bool skip_na = true) const;
+    [[nodiscard]] int64_t count() const;
+
+    // Math Operations
+    ChunkedSeries operator+(ChunkedSeries const& s) const;
+    ChunkedSeries operator+(Scalar const& s) const;
+
+    ChunkedSeries operator-(ChunkedSeries const& s) const;
+    ChunkedSeries operator-(Scalar const& s) const;
+
+    ChunkedSeries operator*(ChunkedSeries const& s) const;
+    ChunkedSeries operator*(Scalar const& s) const;
+
+    ChunkedSeries operator/(ChunkedSeries const& s) const;
+    ChunkedSeries operator/(Scalar const& s) const;
+
+private:
+    arrow::ArrayVector m_chunks;
+    arrow::ArrayVector m_indexChunks;
+    std::shared_ptr<arrow::DataType> m_type;
+    std::string m_name;
+    int64_t m_size{ 0 };
+
+    ChunkedSeries binary(std::string const& function, arrow::Datum const& other)
+        const;
+};
+
+/// A DataFrame stored as a list of record batches sharing one schema, each
+/// with its own index chunk. Appending a day of data adds a batch instead of
+/// rebuilding the history, and loading a multi row group file keeps the row
+/// groups as chunks rather than compacting them with CombineChunksToBatch.
+class ChunkedDataFrame
+{
+public:
+    ChunkedDataFrame() = default;
+
+    explicit ChunkedDataFrame(DataFrame const& df);
+
+    ChunkedDataFrame(
+        std::shared_ptr<arrow::Table> const& table,
+        std::shared_ptr<arrow::ChunkedArray> const& index = nullptr);
+
+    /// O(1), df must have the same schema and index type
+    void append(DataFrame const& df);
+    void append(ChunkedDataFrame const& df);
+
+    /// one chunk per batch of DataFrame::readParquetBatches
+    static ChunkedDataFrame readParquet(
+        std::filesystem::path const& path,
+        ParquetReadOptions const& options = {});
+
+    inline int64_t num_rows() const
+    {
+        return m_numRows;
+    }
+
+    inline int64_t num_columns() const
+    {
+        return m_schema ? m_schema->num_fields() : 0;
+    }
+
+    inline int num_chunks() const
+    {
+        return static_cast<int>(m_batches.size());
+    }
+
+    inline std::shared_ptr<arrow::Schema> schema() const
+    {
+        return m_schema;
+    }
+
+    [[nodiscard]] std::vector<std::string> columnNames() const;
+
+    ChunkedSeries operator[](std::string const& column) const;
+
+    /// zero-copy view of the i-th chunk
+    [[nodiscard]] DataFrame chunk(int i) const;
+
+    [[nodiscard]] ChunkedDataFrame slice(int64_t offset, int64_t length) const;
+
+    [[nodiscard]] std::shared_ptr<arrow::Table> table() const;
+
+    [[nodiscard]] std::shared_ptr<arrow::ChunkedArray> index() const;
+
+    /// concatenates the chunks into one contiguous DataFrame
+    [[nodiscard]] DataFrame combine() const;
+
+private:
+    std::shared_ptr<arrow::Schema> m_schema;
+    arrow::RecordBatchVector m_batches;
+    arrow::ArrayVector m_indexChunks;
+    int64_t m_numRows{ 0 };
+};
+
+}
@@ -5,6 +5,8 @@
 #include <arrow/compute/cast.h>
 #include <boost/chrono/duration.hpp>
 #include <future>
+#include <mutex>
+#include <numeric>
 #include "arrow/compute/exec.h"
 #include "dataframe.h"
 #include "group_by.h"
@@ -285,12 +287,142 @@ std::shared_ptr<arrow::Int64Array> range(int64_t start, int64_t end)
 
 std::shared_ptr<arrow::UInt64Array> range(::uint64_t start, uint64_t end)
 {
-    arrow::UInt64Builder builder;
-    auto rangeView = std::views::iota(start, end);
-    ABORT_NOT_OK(builder.AppendValues(rangeView.begin(), rangeView.end()));
+    return RangeIndex{ start, std::max(start, end) }.array();
+}
 
-    return dynamic_pointer_cast<arrow::UInt64Array>(
-        builder.Finish().MoveValueUnsafe());
+/// first, first + 1, ..., first + capacity - 1. RangeIndex arrays are slices
+/// of the shared buffer starting at 0, or of a private one past it
+struct RangeBuffer : arrow::Buffer
+{
+    explicit RangeBuffer(int64_t capacity, uint64_t first = 0)
+        : arrow::Buffer(nullptr, 0), values(capacity), first(first)
+    {
+        std::iota(values.begin(), values.end(), first);
+        data_ = reinterpret_cast<uint8_t const*>(values.data());
+        size_ = capacity * int64_t(sizeof(uint64_t));
+        capacity_ = size_;
+    }
+
+    std::vector<uint64_t> values;
+    uint64_t first;
+};
+
+static std::mutex rangeBufferMutex;
+static std::shared_ptr<RangeBuffer> rangeBuffer;
+
+/// the shared buffer, when it holds size values or can grow to them
+static std::shared_ptr<RangeBuffer> rangeBufferOfSize(uint64_t size)
+{
+    if (size > uint64_t(PD_RANGE_BUFFER_MAX_SIZE))
+    {
+        return nullptr;
+    }
+
+    std::lock_guard lock(rangeBufferMutex);
+    if (not rangeBuffer or rangeBuffer->values.size() < size)
+    {
+        // grow geometrically, arrays viewing the old buffer keep it alive
+        auto capacity = std::min<uint64_t>(
+            std::max<uint64_t>(
+                { size, 1024, rangeBuffer ? rangeBuffer->values.size() * 2 : 0 }),
+            PD_RANGE_BUFFER_MAX_SIZE);
+        rangeBuffer = std::make_shared<RangeBuffer>(capacity);
+    }
+    return rangeBuffer;
+}
+
+std::shared_ptr<arrow::UInt64Array> RangeIndex::array() const
+{
+    if (step != 1)
+    {
+        arrow::UInt64Builder builder;
+        ThrowOnFailure(builder.Reserve(size()));
+        for (uint64_t i = start; i < stop; i += step)
+        {
+            builder.UnsafeAppend(i);
+        }
+        return dynamic_pointer_cast<arrow::UInt64Array>(
+            ReturnOrThrowOnFailure(builder.Finish()));
+    }
+
+    if (auto buffer = rangeBufferOfSize(stop))
+    {
+        return std::make_shared<arrow::UInt64Array>(
+            size(), buffer, nullptr, 0, int64_t(start));
+    }
+    // past the shared buffer, e.g. the batches deep into a streamed file
+    return std::make_shared<arrow::UInt64Array>(
+        size(), std::make_shared<RangeBuffer>(size(), start));
+}
+
+std::optional<int64_t> RangeIndex::position(arrow::Scalar const& label) const
+{
+    if (not label.is_valid or not arrow::is_integer(label.type->id()))
+    {
+        return std::nullopt;
+    }
+
+    uint64_t v;
+    if (arrow::is_signed_integer(label.type->id()))
+    {
+        auto value = ReturnOrThrowOnFailure(label.CastTo(arrow::int64()));
+        auto signedValue = static_cast<arrow::Int64Scalar const&>(*value).value;
+        if (signedValue < 0)
+        {
+            return std::nullopt;
+        }
+        v = uint64_t(signedValue);
+    }
+    else
+    {
+        auto value = ReturnOrThrowOnFailure(label.CastTo(arrow::uint64()));
+        v = static_cast<arrow::UInt64Scalar const&>(*value).value;
+    }
+    if (v < start or v >= stop or (v - start) % step != 0)
+    {
+        return std::nullopt;
+    }
+    return int64_t((v - start) / step);
+}
+
+std::optional<RangeIndex> RangeIndex::of(std::shared_ptr<arrow::Array> const& index)
+{
+    if (not index or index->type_id() != arrow::Type::UINT64 or
+        index->null_count() != 0)
+    {
+        return std::nullopt;
+    }
+
+    auto const& data = index->data();
+    if (not dynamic_cast<RangeBuffer const*>(data->buffers[1].get()))
+    {
+        return std::nullopt;
+    }
+    auto first = static_cast<RangeBuffer const&>(*data->buffers[1]).first +
+        uint64_t(data->offset);
+    return RangeIndex{ first, first + uint64_t(data->length) };
+}
+
+bool indexEquals(
+    std::shared_ptr<arrow::Array> const& a,
+    std::shared_ptr<arrow::Array> const& b)
+{
+    if (a == b)
+    {
+        return true;
+    }
+    if (not a or not b)
+    {
+        return false;
+    }
+
+    auto rangeA = RangeIndex::of(a);
+    auto rangeB = RangeIndex::of(b);
+    if (rangeA and rangeB)
+    {
+        return *rangeA == *rangeB;
+    }
+    return a->Equals(b);
 }
 
 std::shared_ptr<arrow::Array> combineIndexes(
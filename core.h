@@ -292,6 +292,44 @@ std::shared_ptr<arrow::TimestampArray> date_range(
 std::shared_ptr<arrow::Int64Array> range(int64_t start, int64_t end);
 std::shared_ptr<arrow::UInt64Array> range(::uint64_t start, uint64_t end);
 
+/// values the shared RangeIndex buffer grows to at most
+constexpr int64_t PD_RANGE_BUFFER_MAX_SIZE = { 1 << 24 };
+
+/**
+ * The positional uint64 index [start, stop) by step that every Series and
+ * DataFrame built without an index gets. With step 1 the array is a zero-copy
+ * slice of one shared, lazily grown buffer holding 0, 1, 2, ..., so creating,
+ * slicing, comparing and looking up positions in it is O(1). Ranges ending
+ * past PD_RANGE_BUFFER_MAX_SIZE get a private buffer of their own size
+ * instead, and other steps are materialized.
+ */
+struct RangeIndex
+{
+    uint64_t start{ 0 };
+    uint64_t stop{ 0 };
+    uint64_t step{ 1 };
+
+    inline int64_t size() const
+    {
+        return stop > start ? int64_t((stop - start + step - 1) / step) : 0;
+    }
+
+    std::shared_ptr<arrow::UInt64Array> array() const;
+
+    /// the position of label, std::nullopt when it is not in the range
+    std::optional<int64_t> position(arrow::Scalar const& label) const;
+
+    /// the range index views, std::nullopt when it is not a RangeIndex array
+    static std::optional<RangeIndex> of(std::shared_ptr<arrow::Array> const& index);
+
+    bool operator==(RangeIndex const&) const = default;
+};
+
+/// index equality with an O(1) path for two RangeIndex arrays
+bool indexEquals(
+    std::shared_ptr<arrow::Array> const& a,
+    std::shared_ptr<arrow::Array> const& b);
+
 inline std::shared_ptr<arrow::TimestampScalar> fromDateTime(date const& dt)
 {
     return std::make_shared<arrow::TimestampScalar>(
@@ -6,7 +6,11 @@
 #include <arrow/api.h>
 #include <arrow/compute/exec.h>
 #include <arrow/io/api.h>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <set>
 #include <oneapi/tbb/parallel_for_each.h>
 #include <parquet/arrow/reader.h>
 #include <parquet/arrow/writer.h>
@@ -17,6 +21,8 @@
 #include "arrow/compute/api_vector.h"
 #include "arrow/compute/cast.h"
 #include "arrow/compute/exec/aggregate.h"
+#include "arrow/compute/kernels/cumprod.h"
+#include "arrow/compute/kernels/shift.h"
 #include "arrow/compute/registry.h"
 #include "arrow/table.h"
 #include "arrow/type.h"
@@ -197,59 +203,6 @@ DataFrame DataFrame::setColumns(std::vector<std::string> const& column_names)
     return rename(replace);
 }
 
-DataFrame DataFrame::readParquet(std::filesystem::path const& path)
-{
-
-    auto&& infileStatus = arrow::io::ReadableFile::Open(path);
-    if (infileStatus.ok())
-    {
-        auto infile = std::move(infileStatus).ValueUnsafe();
-
-        std::unique_ptr<parquet::arrow::FileReader> reader;
-        // Open up the file with the IPC features of the library, gives us a reader object.
-        PARQUET_THROW_NOT_OK(parquet::arrow::OpenFile(
-            infile,
-            arrow::default_memory_pool(),
-            &reader));
-
-        std::shared_ptr<arrow::Table> parquet_table;
-        PARQUET_THROW_NOT_OK(reader->ReadTable(&parquet_table));
-
-        arrow::TableBatchReader tableBatchReader(parquet_table);
-        auto recordBatchesResult = tableBatchReader.ToRecordBatches();
-
-        if (recordBatchesResult.ok())
-        {
-            auto rb = recordBatchesResult.MoveValueUnsafe();
-            if (rb.size() == 1)
-            {
-                return rb.at(0);
-            }
-            else if (rb.empty())
-            {
-                throw std::runtime_error(
-                    "Cannot Initialize DataFrame with empty parquet table");
-            }
-            else
-            {
-                std::stringstream ss;
-                ss << "DataFrame Only supports Parquet Table with single record batch\n"
-                      "Found "
-                   << rb.size() << " record batches\n";
-                throw std::runtime_error(ss.str());
-            }
-        }
-        else
-        {
-            throw std::runtime_error(recordBatchesResult.status().ToString());
-        }
-    }
-    else
-    {
-        throw std::runtime_error(infileStatus.status().ToString());
-    }
-}
-
 std::ostream& operator<<(std::ostream& os, DataFrame const& df)
 {
     tabulate::Table table;
@@ -727,6 +680,14 @@ BINARY_OPERATOR_PARALLEL(&, bit_wise_and)
 
 BINARY_OPERATOR_PARALLEL(^, bit_wise_xor)
 
+COMPOUND_OPERATOR_PARALLEL(+, add)
+
+COMPOUND_OPERATOR_PARALLEL(-, subtract)
+
+COMPOUND_OPERATOR_PARALLEL(*, multiply)
+
+COMPOUND_OPERATOR_PARALLEL(/, divide)
+
 BINARY_OPERATOR_PARALLEL(<<, shift_left)
 
 BINARY_OPERATOR_PARALLEL(>>, shift_right)
@@ -824,52 +785,29 @@ DataFrame Series::value_counts() const
     }
 }
 
-pd::DataFrame DataFrame::reindex(std::shared_ptr<arrow::Array> const&newIndex) const noexcept
+pd::DataFrame DataFrame::reindex(std::shared_ptr<arrow::Array> const&newIndex) const
 {
-    auto N = m_array->num_columns();
-    std::vector<pd::ArrayPtr> reindexedSeries(N);
-
-    std::unordered_map<int64_t, int64_t> indexer;
-    auto idx_int = pd::ReturnOrThrowOnFailure(arrow::compute::Cast(m_index, {arrow::int64()})).array_as<arrow::Int64Array>();
-
-    for (int i = 0; i < m_index->length(); i++)
-    {
-        indexer[idx_int->Value(i)] = i;
-    }
-
-    std::ranges::transform(
-        std::views::iota(0L, N),
-        reindexedSeries.begin(),
-        [&](std::int64_t i) {
-            return Series(m_array->column(i), m_index)
-                .reindex(newIndex, indexer)
-                .m_array;
-        });
-    return { m_array->schema(), newIndex->length(), reindexedSeries, newIndex };
+    // the same take indices serve every column, the Indexer casts labels of
+    // another type and misses those that do not fit
+    auto takeIndices = Indexer(m_index).takeIndices(*newIndex);
+    auto result = ReturnOrThrowOnFailure(
+        arrow::compute::Take(m_array, takeIndices));
+    return { result.record_batch(), newIndex };
 }
 
-pd::DataFrame DataFrame::reindexAsync(std::shared_ptr<arrow::Array> const&newIndex) const noexcept
+pd::DataFrame DataFrame::reindexAsync(std::shared_ptr<arrow::Array> const&newIndex) const
 {
     auto N = m_array->num_columns();
-
     std::vector<pd::ArrayPtr> reindexedSeries(N);
-
-    auto idx_int = pd::ReturnOrThrowOnFailure(arrow::compute::Cast(m_index, {arrow::int64()})).array_as<arrow::Int64Array>();
-
-    std::unordered_map<int64_t, int64_t> indexer;
-    for (int i = 0; i < m_index->length(); i++)
-    {
-        indexer[idx_int->Value(i)] = i;
-    }
+    auto takeIndices = Indexer(m_index).takeIndices(*newIndex);
 
     tbb::parallel_for(
         0,
         N,
         [&](size_t i)
         {
-            reindexedSeries[i] = Series(m_array->column(i), m_index)
-                                     .reindex(newIndex, indexer)
-                                     .m_array;
+            reindexedSeries[i] = ReturnOrThrowOnFailure(
+                arrow::compute::Take(*m_array->column(i), *takeIndices));
         });
 
     return { m_array->schema(), newIndex->length(), reindexedSeries, newIndex };
@@ -941,9 +879,15 @@ Series DataFrame::coalesce(std::vector<std::string> const& columns)
     return ReturnSeriesOrThrowOnError( arrow::compute::CallFunction("coalesce", args));
 }
 
-GroupBy DataFrame::group_by(const std::string& key) const
+GroupBy DataFrame::group_by(const std::string& key, bool sorted) const
+{
+    return { key, *this, sorted };
+}
+
+GroupBy DataFrame::group_by(std::vector<std::string> const& keys, bool sorted)
+    const
 {
-    return { key, *this };
+    return { keys, *this, sorted };
 }
 
 DataFrame DataFrame::drop_na() const
@@ -1042,14 +986,82 @@ DataFrame::toTable(std::optional<std::string> const& index_name) const
         arrow::Table::FromRecordBatches({ recordBatchWithIndex }));
 }
 
+arrow::Result<std::shared_ptr<arrow::Array>> GroupBy::applyBatched(
+    std::function<ScalarPtr(::int64_t)> const& fn) const
+{
+    ::int64_t numGroups = groupSize();
+    if (numGroups == 0)
+    {
+        return arrow::MakeArrayOfNull(arrow::null(), 0);
+    }
+
+    // enough groups per task that tiny groups do not drown in scheduling,
+    // tbb still steals halves of a batch when the groups are uneven
+    auto rowsPerGroup = std::max<::int64_t>(1, df.num_rows() / numGroups);
+    auto grain = std::clamp<::int64_t>(
+        PD_APPLY_BATCH_ROWS / rowsPerGroup,
+        1,
+        numGroups);
+
+    std::mutex chunksMutex;
+    std::vector<std::pair<::int64_t, std::shared_ptr<arrow::Array>>> chunks;
+    arrow::Status status;
+    tbb::parallel_for(
+        tbb::blocked_range<::int64_t>(0, numGroups, grain),
+        [&](tbb::blocked_range<::int64_t> const& groups)
+        {
+            auto chunk = [&]() -> arrow::Result<std::shared_ptr<arrow::Array>>
+            {
+                std::unique_ptr<arrow::ArrayBuilder> builder;
+                for (auto group = groups.begin(); group < groups.end(); ++group)
+                {
+                    auto result = fn(group);
+                    if (builder == nullptr)
+                    {
+                        ARROW_ASSIGN_OR_RAISE(builder, arrow::MakeBuilder(result->type));
+                        ARROW_RETURN_NOT_OK(builder->Reserve(groups.size()));
+                    }
+                    ARROW_RETURN_NOT_OK(builder->AppendScalar(*result));
+                }
+                return builder->Finish();
+            }();
+
+            std::lock_guard lock(chunksMutex);
+            if (chunk.ok())
+            {
+                chunks.emplace_back(groups.begin(), chunk.MoveValueUnsafe());
+            }
+            else
+            {
+                status = chunk.status();
+            }
+        });
+    ARROW_RETURN_NOT_OK(status);
+
+    std::ranges::sort(
+        chunks,
+        [](auto const& a, auto const& b) { return a.first < b.first; });
+    arrow::ArrayVector pieces(chunks.size());
+    std::ranges::transform(
+        chunks,
+        pieces.begin(),
+        [](auto const& chunk) { return chunk.second; });
+    if (pieces.size() == 1)
+    {
+        return pieces.front();
+    }
+    return arrow::Concatenate(pieces);
+}
+
 arrow::Result<pd::DataFrame> GroupBy::apply_async(std::function<ScalarPtr (Series const&)> fn)
 {
+    auto const& indexGroups = indexSlices();
     std::shared_ptr<arrow::Schema> schema = df.m_array->schema();
 
     ::int64_t numGroups = groupSize();
     ::int64_t numColumns = schema->num_fields();
 
-    arrow::ArrayDataVector resultForEachColumn(numGroups);
+    arrow::ArrayDataVector resultForEachColumn(numColumns);
     auto columnNames = schema->field_names();
 
     tbb::parallel_for(
@@ -1057,27 +1069,17 @@ arrow::Result<pd::DataFrame> GroupBy::apply_async(std::function<ScalarPtr (Serie
         numColumns,
         [&](::int64_t columnIdx)
         {
-            arrow::ScalarVector result(numGroups);
             std::string const& columnName = columnNames[columnIdx];
-            std::ranges::transform(
-                std::views::iota(0L, numGroups),
-                result.begin(),
+            auto const& columnGroups = columnSlices(columnIdx);
+            auto result = ReturnOrThrowOnFailure(applyBatched(
                 [&](::int64_t groupIdx)
                 {
-                    ScalarPtr key = GetKeyByIndex(groupIdx);
-
-                    ArrayPtr index = indexGroups[key];
-                    int64_t numRows = index->length();
-
-                    arrow::ArrayVector group = groups[key];
-                    ArrayPtr columnInGroup = group[columnIdx];
-
-                    auto seriesFromGroupArray =
-                        pd::Series(columnInGroup, index, columnName);
-                    return fn(seriesFromGroupArray);
-                });
-            resultForEachColumn[columnIdx] =
-                ReturnOrThrowOnFailure(buildData(result));
+                    return fn(pd::Series(
+                        columnGroups[groupIdx],
+                        indexGroups[groupIdx],
+                        columnName));
+                }));
+            resultForEachColumn[columnIdx] = result->data();
         });
 
     return pd::DataFrame(schema, numGroups, resultForEachColumn);
@@ -1085,35 +1087,41 @@ arrow::Result<pd::DataFrame> GroupBy::apply_async(std::function<ScalarPtr (Serie
 
 arrow::Result<pd::Series> GroupBy::apply_async(std::function<ScalarPtr (DataFrame const&)> fn)
 {
-    ::int64_t numGroups = groupSize();
-    arrow::ScalarVector result(numGroups);
+    auto const& indexGroups = indexSlices();
     std::shared_ptr<arrow::Schema> schema = df.m_array->schema();
 
-    tbb::parallel_for(
-        0L,
-        numGroups,
-        [&](::int64_t groupIdx)
-        {
-            ScalarPtr key = GetKeyByIndex(groupIdx);
-            ArrayPtr index = indexGroups[key];
-            arrow::ArrayVector group = groups[key];
-            int64_t numRows = index->length();
-            auto dataFrameGroup = pd::DataFrame(schema, numRows, group, index);
-            result[groupIdx] = fn(dataFrameGroup);
-        });
+    // the slices of every column exist before any task reads them
+    std::vector<arrow::ArrayVector const*> columnGroups(schema->num_fields());
+    for (int i = 0; i < schema->num_fields(); ++i)
+    {
+        columnGroups[i] = &columnSlices(i);
+    }
 
-    ARROW_ASSIGN_OR_RAISE(auto finalArray, buildArray(result));
+    ARROW_ASSIGN_OR_RAISE(
+        auto finalArray,
+        applyBatched(
+            [&](::int64_t groupIdx)
+            {
+                ArrayPtr index = indexGroups[groupIdx];
+                arrow::ArrayVector group(columnGroups.size());
+                for (size_t i = 0; i < columnGroups.size(); ++i)
+                {
+                    group[i] = (*columnGroups[i])[groupIdx];
+                }
+                return fn(pd::DataFrame(schema, index->length(), group, index));
+            }));
     return pd::Series(finalArray, nullptr);
 }
 
 arrow::Result<pd::DataFrame> GroupBy::apply(std::function<ScalarPtr (Series const&)> fn)
 {
+    auto const& indexGroups = indexSlices();
     std::shared_ptr<arrow::Schema> schema = df.m_array->schema();
 
     ::int64_t numGroups = groupSize();
     ::int64_t numColumns = schema->num_fields();
 
-    arrow::ArrayDataVector resultForEachColumn(numGroups);
+    arrow::ArrayDataVector resultForEachColumn(numColumns);
     auto columnNames = schema->field_names();
 
     std::ranges::transform(
@@ -1128,13 +1136,10 @@ arrow::Result<pd::DataFrame> GroupBy::apply(std::function<ScalarPtr (Series cons
                 result.begin(),
                 [&](::int64_t groupIdx)
                 {
-                    ScalarPtr key = GetKeyByIndex(groupIdx);
-
-                    ArrayPtr index = indexGroups[key];
+                    ArrayPtr index = indexGroups[groupIdx];
                     int64_t numRows = index->length();
 
-                    arrow::ArrayVector group = groups[key];
-                    ArrayPtr columnInGroup = group[columnIdx];
+                    ArrayPtr columnInGroup = columnSlices(columnIdx)[groupIdx];
 
                     auto seriesFromGroupArray =
                         pd::Series(columnInGroup, index, columnName);
@@ -1148,6 +1153,7 @@ arrow::Result<pd::DataFrame> GroupBy::apply(std::function<ScalarPtr (Series cons
 
  arrow::Result<pd::Series> GroupBy::apply(std::function<ScalarPtr (DataFrame const&)> fn)
  {
+    auto const& indexGroups = indexSlices();
     ::int64_t numGroups = groupSize();
     arrow::ScalarVector result(numGroups);
     std::shared_ptr<arrow::Schema> schema = df.m_array->schema();
@@ -1157,9 +1163,8 @@ arrow::Result<pd::DataFrame> GroupBy::apply(std::function<ScalarPtr (Series cons
         result.begin(),
         [&](::int64_t i)
         {
-            ScalarPtr key = GetKeyByIndex(i);
-            ArrayPtr index = indexGroups[key];
-            arrow::ArrayVector group = groups[key];
+            ArrayPtr index = indexGroups[i];
+            arrow::ArrayVector group = groupColumns(i);
             int64_t numRows = index->length();
             auto dataFrameGroup = pd::DataFrame(schema, numRows, group, index);
             return fn(dataFrameGroup);
@@ -1169,496 +1174,1170 @@ arrow::Result<pd::DataFrame> GroupBy::apply(std::function<ScalarPtr (Series cons
     return pd::Series(finalArray, nullptr);
  }
 
-GROUPBY_NUMERIC_AGG(mean, double)
-GROUPBY_NUMERIC_AGG(approximate_median, double)
-GROUPBY_NUMERIC_AGG(stddev, double)
-GROUPBY_NUMERIC_AGG(tdigest, double)
-GROUPBY_NUMERIC_AGG(variance, double)
-GROUPBY_NUMERIC_AGG(all, bool)
-GROUPBY_NUMERIC_AGG(any, bool)
+arrow::Result<pd::Series> GroupBy::transform(
+    std::string const& function,
+    std::string const& arg)
+{
+    std::shared_ptr<arrow::Array> perGroup;
+    if (function == "first" or function == "last")
+    {
+        ARROW_ASSIGN_OR_RAISE(auto values, column(arg));
+        ARROW_ASSIGN_OR_RAISE(
+            perGroup,
+            arrow::compute::Take(*values, *boundaryRows(function == "last")));
+    }
+    else if (function == "mode")
+    {
+        ARROW_ASSIGN_OR_RAISE(perGroup, modeOf(arg));
+    }
+    else
+    {
+        ARROW_ASSIGN_OR_RAISE(auto columns, hashAggregate(function, { arg }));
+        perGroup = columns.front();
+    }
 
-GROUPBY_NUMERIC_AGG(count, int64_t)
-GROUPBY_NUMERIC_AGG(count_distinct, int64_t)
+    // a single gather through the group ids, no key lookup per row
+    ARROW_ASSIGN_OR_RAISE(auto data, arrow::compute::Take(*perGroup, *groupIds));
+    return pd::Series(data, df.indexArray(), arg);
+}
 
-GROUPBY_AGG(max)
-GROUPBY_AGG(min)
-GROUPBY_AGG(sum)
-GROUPBY_AGG(product)
+arrow::Result<pd::Series> GroupBy::transform(
+    std::function<pd::Series(Series const&)> const& fn,
+    std::string const& arg)
+{
+    auto columnIndex = df.m_array->schema()->GetFieldIndex(arg);
+    if (columnIndex == -1)
+    {
+        return arrow::Status::KeyError(arg, " is not a column");
+    }
 
+    ::int64_t numGroups = groupSize();
+    if (numGroups == 0)
+    {
+        return pd::Series(df.m_array->column(columnIndex), df.indexArray(), arg);
+    }
 
-arrow::Status GroupBy::processEach(
-    std::unique_ptr<arrow::compute::Grouper> const& grouper,
-    std::shared_ptr<arrow::ListArray> const& groupings,
-    std::shared_ptr<arrow::Array> const& column)
-{
-    using namespace arrow;
-    using namespace arrow::compute;
+    auto const& slices = columnSlices(columnIndex);
+    auto const& index = indexSlices();
 
-    ARROW_ASSIGN_OR_RAISE(
-        auto grouped_argument,
-        Grouper::ApplyGroupings(*groupings, *column));
+    arrow::ArrayVector results(numGroups);
+    std::mutex errorMutex;
+    arrow::Status status;
+    tbb::parallel_for(
+        0L,
+        numGroups,
+        [&](::int64_t group)
+        {
+            auto result =
+                fn(pd::Series(slices[group], index[group], arg)).m_array;
+            auto length = result->length();
+            if (length != slices[group]->length() and length != 1)
+            {
+                std::lock_guard lock(errorMutex);
+                status = arrow::Status::Invalid(
+                    "transform expects ",
+                    slices[group]->length(),
+                    " values or a single one for group ",
+                    group,
+                    ", got ",
+                    length);
+                return;
+            }
+            results[group] = std::move(result);
+        });
+    ARROW_RETURN_NOT_OK(status);
 
-    for (int64_t i_group = 0; i_group < grouper->num_groups(); ++i_group)
+    std::vector<int64_t> offsets(numGroups + 1, 0);
+    for (::int64_t group = 0; group < numGroups; ++group)
     {
-        ARROW_ASSIGN_OR_RAISE(
-            std::shared_ptr<arrow::Scalar> keyScalar,
-            uniqueKeys->GetScalar(i_group));
-
-        groups[keyScalar].emplace_back(grouped_argument->value_slice(i_group));
+        offsets[group + 1] = offsets[group] + results[group]->length();
     }
-    return arrow::Status::OK();
+    ARROW_ASSIGN_OR_RAISE(auto all, arrow::Concatenate(results));
+
+    // the slices keep the rows of a group in order, so the j-th row of a
+    // group reads the j-th result, or the only one
+    auto ids = groupIds->raw_values();
+    std::vector<int64_t> seen(numGroups, 0);
+    std::vector<int64_t> sources(groupIds->length());
+    for (int64_t row = 0; row < groupIds->length(); ++row)
+    {
+        auto group = ids[row];
+        auto position = seen[group]++;
+        sources[row] = offsets[group] +
+            (results[group]->length() == 1 ? 0 : position);
+    }
+
+    ARROW_ASSIGN_OR_RAISE(
+        auto data,
+        arrow::compute::Take(*all, *arrow::ArrayT<int64_t>::Make(sources)));
+    return pd::Series(data, df.indexArray(), arg);
 }
 
-arrow::Status GroupBy::processIndex(
-    std::unique_ptr<arrow::compute::Grouper> const& grouper,
-    std::shared_ptr<arrow::ListArray> const& groupings)
+arrow::Result<pd::Series> GroupBy::segmentWise(
+    std::string const& arg,
+    std::function<arrow::Result<std::shared_ptr<arrow::Array>>(
+        std::shared_ptr<arrow::Array> const&)> const& fn) const
 {
-    using namespace arrow;
-    using namespace arrow::compute;
+    ARROW_ASSIGN_OR_RAISE(auto values, column(arg));
+    ::int64_t numGroups = groupSize();
+    if (numGroups == 0)
+    {
+        return pd::Series(values, df.indexArray(), arg);
+    }
 
-    ARROW_ASSIGN_OR_RAISE(
-        auto grouped_argument,
-        Grouper::ApplyGroupings(*groupings, *df.indexArray()));
+    // groupings() lists the rows of every group in order, a counting sort of
+    // the rows by group id. Groups that are runs are in order already
+    std::shared_ptr<arrow::Int32Array> rows;
+    std::shared_ptr<arrow::Array> ordered = values;
+    std::vector<int64_t> offsets = runs;
+    if (runs.empty())
+    {
+        auto const& grouping = *groupings();
+        rows = std::static_pointer_cast<arrow::Int32Array>(grouping.values());
+        ARROW_ASSIGN_OR_RAISE(ordered, arrow::compute::Take(*values, *rows));
+        offsets.resize(numGroups + 1);
+        for (::int64_t group = 0; group <= numGroups; ++group)
+        {
+            offsets[group] = grouping.value_offset(group);
+        }
+    }
+
+    arrow::ArrayVector results(numGroups);
+    std::mutex errorMutex;
+    arrow::Status status;
+    tbb::parallel_for(
+        0L,
+        numGroups,
+        [&](::int64_t group)
+        {
+            auto length = offsets[group + 1] - offsets[group];
+            auto result = fn(ordered->Slice(offsets[group], length));
+            if (result.ok() and (*result)->length() != length)
+            {
+                result = arrow::Status::Invalid(
+                    "expected ", length, " values for group ", group);
+            }
+            if (not result.ok())
+            {
+                std::lock_guard lock(errorMutex);
+                status = result.status();
+                return;
+            }
+            results[group] = result.MoveValueUnsafe();
+        });
+    ARROW_RETURN_NOT_OK(status);
+    ARROW_ASSIGN_OR_RAISE(auto data, arrow::Concatenate(results));
 
-    for (int64_t i_group = 0; i_group < grouper->num_groups(); ++i_group)
+    if (rows != nullptr)
     {
+        // the k-th value in group order belongs to row rows[k]
+        std::vector<int64_t> positions(rows->length());
+        auto rowValues = rows->raw_values();
+        tbb::parallel_for(
+            0L,
+            rows->length(),
+            [&](::int64_t k) { positions[rowValues[k]] = k; });
         ARROW_ASSIGN_OR_RAISE(
-            std::shared_ptr<arrow::Scalar> keyScalar,
-            uniqueKeys->GetScalar(i_group));
-        indexGroups[keyScalar] = grouped_argument->value_slice(i_group);
+            data,
+            arrow::compute::Take(*data, *arrow::ArrayT<int64_t>::Make(positions)));
     }
-    return arrow::Status::OK();
+    return pd::Series(data, df.indexArray(), arg);
 }
 
-arrow::Status GroupBy::makeGroups(std::string const& keyInStringFormat)
+arrow::Result<pd::Series> GroupBy::cumsum(
+    std::string const& arg,
+    bool skip_nulls) const
 {
-    using namespace arrow;
-    using namespace arrow::compute;
+    return segmentWise(
+        arg,
+        [skip_nulls](std::shared_ptr<arrow::Array> const& values)
+            -> arrow::Result<std::shared_ptr<arrow::Array>>
+        {
+            ARROW_ASSIGN_OR_RAISE(
+                auto result,
+                arrow::compute::CumulativeSum(
+                    values,
+                    arrow::compute::CumulativeSumOptions{ 0.0, skip_nulls }));
+            return result.make_array();
+        });
+}
 
-    auto schema = df.array()->schema();
-    auto key_array =
-        keyInStringFormat == "__resampler_idx__" ? df.indexArray() : df[keyInStringFormat].array();
-    ARROW_ASSIGN_OR_RAISE(
-        auto key_batch,
-        ExecBatch::Make(std::vector<Datum>{ key_array }));
+arrow::Result<pd::Series> GroupBy::cumprod(
+    std::string const& arg,
+    bool skip_nulls) const
+{
+    return segmentWise(
+        arg,
+        [skip_nulls](std::shared_ptr<arrow::Array> const& values)
+            -> arrow::Result<std::shared_ptr<arrow::Array>>
+        {
+            ARROW_ASSIGN_OR_RAISE(
+                auto result,
+                arrow::compute::CumulativeProduct(
+                    values,
+                    arrow::compute::CumulativeProductOptions{ 1, skip_nulls }));
+            return result.make_array();
+        });
+}
+
+// values moved by periods within one group, the vacated positions are taken
+// from fill. A shift longer than the group leaves only fill, so every group
+// keeps its length
+static arrow::Result<std::shared_ptr<arrow::Array>> shiftGroup(
+    std::shared_ptr<arrow::Array> const& values,
+    int32_t periods,
+    std::shared_ptr<arrow::Array> const& fill)
+{
+    auto length = values->length();
+    auto vacated = std::min<int64_t>(std::abs(int64_t{ periods }), length);
+    if (vacated == 0)
+    {
+        return values;
+    }
+    if (vacated == length)
+    {
+        return fill->Slice(0, length);
+    }
+    auto kept = values->Slice(periods > 0 ? 0 : vacated, length - vacated);
+    return periods > 0 ? arrow::Concatenate({ fill->Slice(0, vacated), kept })
+                       : arrow::Concatenate({ kept, fill->Slice(0, vacated) });
+}
 
-    ARROW_ASSIGN_OR_RAISE(auto grouper, Grouper::Make(key_batch.GetTypes()));
+// one run of fill_value (or nulls) long enough for any group, sliced per group
+// instead of boxing every value through a builder
+static arrow::Result<std::shared_ptr<arrow::Array>> shiftFill(
+    std::shared_ptr<arrow::DataType> const& type,
+    int32_t periods,
+    int64_t rows,
+    std::shared_ptr<arrow::Scalar> const& fill_value)
+{
+    auto length = std::min<int64_t>(std::abs(int64_t{ periods }), rows);
+    if (fill_value == nullptr)
+    {
+        return arrow::MakeArrayOfNull(type, length);
+    }
+    std::shared_ptr<arrow::Scalar> fill = fill_value;
+    if (not fill->type->Equals(*type))
+    {
+        ARROW_ASSIGN_OR_RAISE(fill, fill->CastTo(type));
+    }
+    return arrow::MakeArrayFromScalar(*fill, length);
+}
 
+arrow::Result<pd::Series> GroupBy::shift(
+    std::string const& arg,
+    int32_t periods,
+    std::shared_ptr<arrow::Scalar> const& fill_value) const
+{
+    ARROW_ASSIGN_OR_RAISE(auto values, column(arg));
     ARROW_ASSIGN_OR_RAISE(
-        Datum id_batch,
-        grouper->Consume(ExecSpan(key_batch)));
+        auto fill,
+        shiftFill(values->type(), periods, values->length(), fill_value));
+    return segmentWise(
+        arg,
+        [&](std::shared_ptr<arrow::Array> const& group)
+        { return shiftGroup(group, periods, fill); });
+}
 
+arrow::Result<pd::Series> GroupBy::diff(
+    std::string const& arg,
+    int32_t periods) const
+{
+    ARROW_ASSIGN_OR_RAISE(auto values, column(arg));
     ARROW_ASSIGN_OR_RAISE(
-        auto groupings,
-        Grouper::MakeGroupings(
-            *id_batch.array_as<UInt32Array>(),
-            grouper->num_groups()));
-
-    ARROW_ASSIGN_OR_RAISE(auto uniques, grouper->GetUniques());
-    uniqueKeys = uniques.values[0].make_array();
+        auto fill,
+        shiftFill(values->type(), periods, values->length(), nullptr));
+    return segmentWise(
+        arg,
+        [&](std::shared_ptr<arrow::Array> const& group)
+            -> arrow::Result<std::shared_ptr<arrow::Array>>
+        {
+            ARROW_ASSIGN_OR_RAISE(
+                auto shifted,
+                shiftGroup(group, periods, fill));
+            ARROW_ASSIGN_OR_RAISE(
+                auto result,
+                arrow::compute::Subtract(group, shifted));
+            return result.make_array();
+        });
+}
 
-    RETURN_NOT_OK(processIndex(grouper, groupings));
+arrow::Result<pd::Series> GroupBy::rank(
+    std::string const& arg,
+    bool ascending,
+    arrow::compute::RankOptions::Tiebreaker tiebreaker) const
+{
+    arrow::compute::RankOptions options(
+        ascending ? arrow::compute::SortOrder::Ascending
+                  : arrow::compute::SortOrder::Descending,
+        arrow::compute::NullPlacement::AtEnd,
+        tiebreaker);
+    return segmentWise(
+        arg,
+        [&](std::shared_ptr<arrow::Array> const& values)
+            -> arrow::Result<std::shared_ptr<arrow::Array>>
+        {
+            ARROW_ASSIGN_OR_RAISE(
+                auto result,
+                arrow::compute::CallFunction("rank", { values }, &options));
+            return result.make_array();
+        });
+}
 
-    for (auto const& col : df.m_array->columns())
+GroupByRolling GroupBy::rolling(
+    int64_t window,
+    std::optional<int64_t> minPeriods) const
+{
+    if (window < 1)
     {
-        RETURN_NOT_OK(processEach(grouper, groupings, col));
+        throw std::invalid_argument("rolling window must be at least 1");
     }
+    return GroupByRolling{ *this, window, minPeriods.value_or(window) };
+}
 
-    return arrow::Status::OK();
+arrow::Result<pd::Series> GroupByRolling::sum(std::string const& arg) const
+{
+    return apply(arg, false);
 }
 
-arrow::Result<pd::DataFrame> GroupBy::min_max(
-    std::vector<std::string> const& args)
+arrow::Result<pd::Series> GroupByRolling::mean(std::string const& arg) const
 {
-    auto schema = df.m_array->schema();
-    auto N = groups.size();
+    return apply(arg, true);
+}
 
-    arrow::FieldVector fv;
-    for (auto const& arg : args)
-    {
-        auto type = schema->GetFieldByName(arg)->type();
-        fv.push_back(arrow::field(arg + "_min", type));
-        fv.push_back(arrow::field(arg + "_max", type));
-    }
+arrow::Result<pd::Series> GroupByRolling::apply(
+    std::string const& arg,
+    bool mean) const
+{
+    return groupBy.segmentWise(
+        arg,
+        [&](std::shared_ptr<arrow::Array> const& segment)
+            -> arrow::Result<std::shared_ptr<arrow::Array>>
+        {
+            ARROW_ASSIGN_OR_RAISE(
+                auto cast,
+                arrow::compute::Cast(*segment, arrow::float64()));
+            auto const& values = static_cast<arrow::DoubleArray const&>(*cast);
+            auto present = [&](int64_t i)
+            { return values.IsValid(i) and not std::isnan(values.Value(i)); };
+
+            // running sum of the finite values in the window, the row leaving
+            // it is taken back out. Infinities are counted instead of summed,
+            // inf - inf would turn the sum into NaN for good, and the
+            // compensation keeps the rounding of the removals from drifting
+            auto n = values.length();
+            std::vector<double> result(n);
+            std::vector<bool> valid(n);
+            double sum = 0, compensation = 0;
+            int64_t count = 0, finite = 0, positive = 0, negative = 0;
+            auto add = [&](double x)
+            {
+                auto t = sum + x;
+                compensation += std::abs(sum) >= std::abs(x) ? (sum - t) + x
+                                                             : (x - t) + sum;
+                sum = t;
+            };
+            auto update = [&](int64_t i, int64_t sign)
+            {
+                auto x = values.Value(i);
+                count += sign;
+                if (std::isfinite(x))
+                {
+                    finite += sign;
+                    add(sign * x);
+                }
+                else
+                {
+                    (x > 0 ? positive : negative) += sign;
+                }
+            };
+            for (int64_t i = 0; i < n; ++i)
+            {
+                if (present(i))
+                {
+                    update(i, 1);
+                }
+                if (i >= window and present(i - window))
+                {
+                    update(i - window, -1);
+                }
+                if (finite == 0)
+                {
+                    sum = compensation = 0;
+                }
 
-    long keysLength = uniqueKeys->length();
-    arrow::ArrayDataVector array(fv.size());
+                double total = sum + compensation;
+                if (positive > 0 or negative > 0)
+                {
+                    total = positive > 0 and negative > 0 ?
+                        std::numeric_limits<double>::quiet_NaN() :
+                        (positive > 0 ? 1 : -1) *
+                            std::numeric_limits<double>::infinity();
+                }
+                valid[i] = count > 0 and count >= minPeriods;
+                result[i] = mean and count > 0 ? total / static_cast<double>(count)
+                                               : total;
+            }
+            return arrow::ArrayT<double>::Make(result, valid);
+        });
+}
 
-    for (size_t i = 0; i < args.size(); i++)
+StreamingGroupBy::StreamingGroupBy(
+    std::vector<std::string> keys,
+    std::vector<std::pair<std::string, std::vector<std::string>>> aggregations)
+    : m_keys(std::move(keys)), m_aggregations(std::move(aggregations))
+{
+    static std::set<std::string> const covered{
+        "sum", "count", "mean", "min", "max", "last",
+        "var", "variance", "std", "stddev"
+    };
+    if (m_keys.empty())
     {
-        const auto& arg = args[i];
-        int index = schema->GetFieldIndex(arg);
-
-        arrow::ScalarVector min(keysLength), max(keysLength);
-        tbb::parallel_for(
-            0L,
-            keysLength,
-            [&](size_t j)
-            {
-                auto key = uniqueKeys->GetScalar(long(j)).MoveValueUnsafe();
-                auto& group = groups.at(key);
-
-                auto d =
-                    ReturnOrThrowOnFailure(arrow::compute::MinMax(group[index]))
-                        .scalar_as<arrow::StructScalar>()
-                        .value;
-                min[j] = d[0];
-                max[j] = d[1];
-            });
-
-        std::shared_ptr<arrow::ArrayBuilder> minBuilder, maxBuilder;
-        if (not min.empty())
+        throw std::invalid_argument("group_by needs at least one key");
+    }
+    for (auto const& [arg, functions] : m_aggregations)
+    {
+        for (auto const& function : functions)
         {
-            minBuilder =
-                ReturnOrThrowOnFailure(arrow::MakeBuilder(min.back()->type));
-            maxBuilder =
-                ReturnOrThrowOnFailure(arrow::MakeBuilder(max.back()->type));
+            if (not covered.contains(function))
+            {
+                throw std::invalid_argument(
+                    function + " of " + arg + " is not accumulated over batches");
+            }
+        }
+    }
+}
 
-            RETURN_NOT_OK(minBuilder->AppendScalars(min));
-            RETURN_NOT_OK(maxBuilder->AppendScalars(max));
+arrow::Status StreamingGroupBy::consume(arrow::RecordBatch const& batch)
+{
+    // everything is checked before any state changes
+    arrow::ArrayVector keys;
+    for (auto const& key : m_keys)
+    {
+        auto column = batch.GetColumnByName(key);
+        if (column == nullptr)
+        {
+            return arrow::Status::KeyError(key, " is not a column");
+        }
+        if (m_grouper and not column->type()->Equals(*m_keyTypes[keys.size()]))
+        {
+            return arrow::Status::TypeError(
+                "key ", key, " was ", m_keyTypes[keys.size()]->ToString(),
+                ", got ", column->type()->ToString());
         }
+        keys.push_back(column);
+    }
 
-        std::shared_ptr<arrow::ArrayData> min_data, max_data;
-        RETURN_NOT_OK(minBuilder->FinishInternal(&min_data));
-        RETURN_NOT_OK(maxBuilder->FinishInternal(&max_data));
+    arrow::ArrayVector values;
+    for (auto const& aggregation : m_aggregations)
+    {
+        auto const& arg = aggregation.first;
+        auto column = batch.GetColumnByName(arg);
+        if (column == nullptr)
+        {
+            return arrow::Status::KeyError(arg, " is not a column");
+        }
+        if (not GroupAccumulator::covers(*column->type()) or
+            (m_grouper and
+             not column->type()->Equals(*m_accumulators[values.size()].type())))
+        {
+            return arrow::Status::TypeError(
+                arg, " cannot be accumulated as ", column->type()->ToString());
+        }
+        values.push_back(column);
+    }
 
-        array[i * 2] = min_data;
-        array[i * 2 + 1] = max_data;
+    if (m_grouper == nullptr)
+    {
+        std::vector<arrow::TypeHolder> types;
+        for (auto const& key : keys)
+        {
+            types.emplace_back(key->type());
+        }
+        ARROW_ASSIGN_OR_RAISE(m_grouper, arrow::compute::Grouper::Make(types));
+        for (auto const& key : keys)
+        {
+            m_keyTypes.push_back(key->type());
+        }
+        for (auto const& column : values)
+        {
+            m_accumulators.emplace_back(column->type());
+        }
+    }
+    if (batch.num_rows() == 0)
+    {
+        return arrow::Status::OK();
     }
 
-    return pd::DataFrame(arrow::schema(fv), long(N), array);
+    // the batch is grouped in parallel, the running grouper only numbers its
+    // distinct keys
+    ARROW_ASSIGN_OR_RAISE(auto groups, GroupRows(keys));
+    std::vector<arrow::Datum> uniques(groups.uniques.begin(), groups.uniques.end());
+    ARROW_ASSIGN_OR_RAISE(auto uniqueBatch, arrow::compute::ExecBatch::Make(uniques));
+    ARROW_ASSIGN_OR_RAISE(
+        auto running,
+        m_grouper->Consume(arrow::compute::ExecSpan(uniqueBatch)));
+    auto runningIds = running.array_as<arrow::UInt32Array>();
+
+    GroupReducer reducer(
+        groups.ids,
+        groups.uniques.front()->length(),
+        std::move(groups.runs));
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        ARROW_RETURN_NOT_OK(m_accumulators[i].consume(
+            reducer,
+            *runningIds,
+            groupSize(),
+            *values[i]));
+    }
+    return arrow::Status::OK();
 }
 
-arrow::Result<pd::DataFrame> GroupBy::min_max(std::string const& arg)
+arrow::Result<pd::DataFrame> StreamingGroupBy::snapshot() const
 {
-    auto schema = df.m_array->schema();
-    auto N = groups.size();
-
-    auto fv = schema->GetFieldByName(arg);
-
-    long L = uniqueKeys->length();
-    int index = schema->GetFieldIndex(arg);
+    if (m_grouper == nullptr)
+    {
+        return arrow::Status::Invalid("no batch has been consumed yet");
+    }
 
-    arrow::ScalarVector min(L), max(L);
-    tbb::parallel_for(0l, L,
-        [&](size_t j)
+    ARROW_ASSIGN_OR_RAISE(auto uniques, m_grouper->GetUniques());
+    arrow::ArrayVector keyColumns;
+    for (auto const& key : uniques.values)
+    {
+        keyColumns.push_back(key.make_array());
+    }
+    std::shared_ptr<arrow::Array> index = keyColumns.front();
+    if (m_keys.size() > 1)
+    {
+        ARROW_ASSIGN_OR_RAISE(index, arrow::StructArray::Make(keyColumns, m_keys));
+    }
 
-            {
-                auto key = uniqueKeys->GetScalar(long(j)).MoveValueUnsafe();
-                auto& group = groups.at(key);
+    arrow::FieldVector fields;
+    arrow::ArrayVector columns;
+    for (size_t i = 0; i < m_aggregations.size(); ++i)
+    {
+        auto const& [arg, functions] = m_aggregations[i];
+        for (auto const& function : functions)
+        {
+            ARROW_ASSIGN_OR_RAISE(
+                auto column,
+                m_accumulators[i].finish(
+                    function == "std"   ? "stddev"
+                        : function == "var" ? "variance"
+                                            : function));
+            fields.push_back(arrow::field(
+                functions.size() == 1 ? arg : arg + "_" + function,
+                column->type()));
+            columns.push_back(std::move(column));
+        }
+    }
+    return pd::DataFrame{ arrow::RecordBatch::Make(
+                              arrow::schema(fields),
+                              groupSize(),
+                              columns),
+                          index };
+}
 
-                auto d = ReturnOrThrowOnFailure(arrow::compute::MinMax(group[index]))
-                             .scalar_as<arrow::StructScalar>().value;
-                min[j] = d[0];
-                max[j] = d[1];
-            });
+GROUPBY_HASH_AGG(mean)
+GROUPBY_HASH_AGG(approximate_median)
+GROUPBY_HASH_AGG(stddev)
+GROUPBY_HASH_AGG(tdigest)
+GROUPBY_HASH_AGG(variance)
+GROUPBY_HASH_AGG(all)
+GROUPBY_HASH_AGG(any)
+GROUPBY_HASH_AGG(count)
+GROUPBY_HASH_AGG(count_distinct)
+GROUPBY_HASH_AGG(max)
+GROUPBY_HASH_AGG(min)
+GROUPBY_HASH_AGG(sum)
+GROUPBY_HASH_AGG(product)
+
+std::shared_ptr<arrow::ListArray> const& GroupBy::groupings() const
+{
+    std::call_once(
+        groupSlices->groupingsBuilt,
+        [this]
+        {
+            groupSlices->groupings =
+                ReturnOrThrowOnFailure(arrow::compute::Grouper::MakeGroupings(
+                    *groupIds,
+                    static_cast<uint32_t>(groupSize())));
+        });
+    return groupSlices->groupings;
+}
 
-    std::shared_ptr<arrow::DataType> dtype;
-    std::shared_ptr<arrow::ArrayBuilder> minBuilder, maxBuilder;
-    if (not min.empty())
+arrow::ArrayVector GroupBy::splitGroups(arrow::Array const& column) const
+{
+    if (not runs.empty())
     {
-        dtype = min.back()->type;
-        minBuilder = ReturnOrThrowOnFailure(arrow::MakeBuilder(dtype));
-        maxBuilder = ReturnOrThrowOnFailure(arrow::MakeBuilder(dtype));
-
-        RETURN_NOT_OK(minBuilder->AppendScalars(min));
-        RETURN_NOT_OK(maxBuilder->AppendScalars(max));
+        // contiguous groups are zero-copy slices
+        arrow::ArrayVector result(groupSize());
+        for (size_t i = 0; i < result.size(); ++i)
+        {
+            result[i] = column.Slice(runs[i], runs[i + 1] - runs[i]);
+        }
+        return result;
     }
 
-    std::shared_ptr<arrow::ArrayData> min_data, max_data;
-    RETURN_NOT_OK(minBuilder->FinishInternal(&min_data));
-    RETURN_NOT_OK(maxBuilder->FinishInternal(&max_data));
-
-    return pd::DataFrame{ arrow::schema(
-                              arrow::FieldVector{ arrow::field("min", dtype),
-                                                  arrow::field("max", dtype) }),
-                          L,
-                          arrow::ArrayDataVector{ min_data, max_data } };
+    auto grouped = ReturnOrThrowOnFailure(
+        arrow::compute::Grouper::ApplyGroupings(*groupings(), column));
+    arrow::ArrayVector result(grouped->length());
+    for (int64_t i = 0; i < grouped->length(); ++i)
+    {
+        result[i] = grouped->value_slice(i);
+    }
+    return result;
 }
 
-arrow::Result<pd::DataFrame> GroupBy::first(
-    std::vector<std::string> const& args)
+arrow::ArrayVector const& GroupBy::indexSlices() const
 {
-    auto schema = df.m_array->schema();
-    auto N = groups.size();
-
-    auto fv = fieldVectors(args, schema);
-    arrow::ArrayDataVector arr(args.size());
+    std::call_once(
+        groupSlices->indexBuilt,
+        [this]
+        { groupSlices->index = splitGroups(*df.indexArray()); });
+    return groupSlices->index;
+}
 
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, args.size()),
-        [&](const tbb::blocked_range<size_t>& r)
+arrow::ArrayVector const& GroupBy::columnSlices(int column) const
+{
+    std::call_once(
+        groupSlices->columnBuilt[column],
+        [this, column]
         {
-            for (size_t i = r.begin(); i != r.end(); ++i)
-            {
-                const auto& arg = args[i];
-                long L = uniqueKeys->length();
-                int index = schema->GetFieldIndex(arg);
-
-                arrow::ScalarVector result(L);
-                tbb::parallel_for(
-                    0L,
-                    L,
-                    [&](size_t j)
-                    {
-                        auto key =
-                            uniqueKeys->GetScalar(long(j)).MoveValueUnsafe();
-                        auto& group = groups.at(key);
-                        ARROW_ASSIGN_OR_RAISE(
-                            result[j],
-                            group[index]->GetScalar(0));
-                    });
-
-                ARROW_ASSIGN_OR_RAISE(arr[i], buildData(result));
-            }
+            groupSlices->columns[column] =
+                splitGroups(*df.m_array->column(column));
         });
+    return groupSlices->columns[column];
+}
 
-    return pd::DataFrame(arrow::schema(fv), long(N), arr);
+arrow::ArrayVector GroupBy::groupColumns(int64_t group) const
+{
+    arrow::ArrayVector result(df.num_columns());
+    for (int i = 0; i < df.num_columns(); ++i)
+    {
+        result[i] = columnSlices(i)[group];
+    }
+    return result;
 }
 
-arrow::Result<pd::Series> GroupBy::first(std::string const& arg)
+GroupBy GroupBy::operator[](std::vector<std::string> const& columns) const
 {
-    auto schema = df.m_array->schema();
-    auto N = groups.size();
+    GroupBy result{ *this };
+    result.df = df[columns];
+    result.groupSlices = std::make_shared<Slices>(columns.size());
+    return result;
+}
 
-    auto fv = schema->GetFieldByName(arg);
+arrow::Status GroupBy::makeGroups(
+    std::vector<std::string> const& keys,
+    bool sorted)
+{
+    using namespace arrow;
+    using namespace arrow::compute;
 
-    long L = uniqueKeys->length();
-    int index = schema->GetFieldIndex(arg);
+    if (keys.empty())
+    {
+        return Status::Invalid("group_by needs at least one key");
+    }
 
-    arrow::ScalarVector result(L);
-    //    tbb::parallel_for(
-    tbb::blocked_range<size_t> r(0, L);
-    //        [&](const tbb::blocked_range<size_t>& r)
-    //        {
-    for (size_t j = r.begin(); j != r.end(); ++j)
+    ArrayVector keyArrays;
+    for (auto const& key : keys)
     {
-        auto key = uniqueKeys->GetScalar(long(j)).MoveValueUnsafe();
-        auto& group = groups.at(key);
+        if (key == "__resampler_idx__")
+        {
+            keyArrays.emplace_back(df.indexArray());
+        }
+        else
+        {
+            ARROW_ASSIGN_OR_RAISE(auto keyArray, column(key));
+            keyArrays.emplace_back(keyArray);
+        }
+    }
 
-        ARROW_ASSIGN_OR_RAISE(result[j], group[index]->GetScalar(0));
+    ARROW_ASSIGN_OR_RAISE(auto groups, GroupRows(keyArrays, sorted));
+    groupIds = groups.ids;
+    runs = std::move(groups.runs);
+    if (keys.size() == 1)
+    {
+        uniqueKeys = groups.uniques.front();
+    }
+    else
+    {
+        ARROW_ASSIGN_OR_RAISE(
+            uniqueKeys,
+            StructArray::Make(groups.uniques, keys));
     }
-    //        });
+    keyIndexer = Indexer(uniqueKeys);
+    reducer = std::make_shared<GroupReducer>(groupIds, uniqueKeys->length(), runs);
+    groupSlices = std::make_shared<Slices>(df.num_columns());
 
-    ARROW_ASSIGN_OR_RAISE(auto data, buildArray(result));
-    return pd::Series(data, nullptr);
+    return arrow::Status::OK();
 }
 
-arrow::Result<pd::DataFrame> GroupBy::last(
-    std::vector<std::string> const& args)
+arrow::ArrayVector GroupBy::group(arrow::ScalarVector const& values) const
 {
-    auto schema = df.m_array->schema();
-    auto N = groups.size();
-
-    auto fv = fieldVectors(args, schema);
-    arrow::ArrayDataVector arr(args.size());
-
-    tbb::parallel_for(
-        0ul,
-        args.size(),
-        [&](size_t i)
+    if (uniqueKeys->type_id() != arrow::Type::STRUCT)
+    {
+        if (values.size() != 1)
         {
-            const auto& arg = args[i];
-            long L = uniqueKeys->length();
-            int index = schema->GetFieldIndex(arg);
-
-            arrow::ScalarVector result(L);
-            tbb::parallel_for(
-                0L,
-                L,
-                [&](size_t j)
-                {
-                    auto key = uniqueKeys->GetScalar(long(j)).MoveValueUnsafe();
-                    auto& group = groups.at(key);
-                    auto groupLength = group[index]->length();
-                    auto lastIndex = groupLength - 1;
-                    ARROW_ASSIGN_OR_RAISE(
-                        result[j],
-                        group[index]->GetScalar(lastIndex));
-                });
+            throw std::invalid_argument("expected a single key value");
+        }
+        return groupColumns(keyIndexer.at(values.front()));
+    }
 
-            ARROW_ASSIGN_OR_RAISE(arr[i], buildData(result));
-        });
+    auto const& type = static_cast<arrow::StructType const&>(*uniqueKeys->type());
+    if (values.size() != static_cast<size_t>(type.num_fields()))
+    {
+        throw std::invalid_argument("expected one value per key column");
+    }
 
-    return pd::DataFrame(arrow::schema(fv), long(N), arr);
+    // the scalars are cast to the key types, so a literal 1 finds an int32 key
+    arrow::ScalarVector fields(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        fields[i] = ReturnOrThrowOnFailure(values[i]->CastTo(type.field(i)->type()));
+    }
+    auto key = std::make_shared<arrow::StructScalar>(fields, uniqueKeys->type());
+    return groupColumns(keyIndexer.at(key));
 }
 
-arrow::Result<pd::Series> GroupBy::last(
-    std::string const& arg)
+arrow::Result<std::shared_ptr<arrow::Array>> GroupBy::column(
+    std::string const& name) const
 {
-    auto schema = df.m_array->schema();
-    auto N = groups.size();
+    auto result = df.m_array->GetColumnByName(name);
+    if (result == nullptr)
+    {
+        return arrow::Status::KeyError(name, " is not a column");
+    }
+    return result;
+}
 
-    auto fv = schema->GetFieldByName(arg);
+arrow::Result<arrow::ArrayVector> GroupBy::hashAggregate(
+    std::string const& function,
+    std::vector<std::string> const& args,
+    std::shared_ptr<arrow::compute::FunctionOptions> const& options) const
+{
+    arrow::ArrayVector columns(args.size());
+    std::vector<size_t> viaKernels;
+    arrow::ArrayVector kernelValues;
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        ARROW_ASSIGN_OR_RAISE(auto values, column(args[i]));
+        if (options == nullptr)
+        {
+            ARROW_ASSIGN_OR_RAISE(columns[i], reducer->reduce(function, *values));
+        }
+        if (columns[i] == nullptr)
+        {
+            viaKernels.push_back(i);
+            kernelValues.push_back(values);
+        }
+    }
+    if (kernelValues.empty())
+    {
+        return columns;
+    }
 
-    long L = uniqueKeys->length();
-    int index = schema->GetFieldIndex(arg);
+    ARROW_ASSIGN_OR_RAISE(
+        auto results,
+        hashKernels(
+            std::vector<std::string>(kernelValues.size(), function),
+            kernelValues,
+            options));
+    for (size_t i = 0; i < viaKernels.size(); ++i)
+    {
+        columns[viaKernels[i]] = results[i];
+    }
+    return columns;
+}
 
-    arrow::ScalarVector result(L);
-    std::ranges::transform(
-        std::views::iota(0, L),
-        result.begin(),
-        [&](int j)
-        {
-            auto key = uniqueKeys->GetScalar(long(j)).MoveValueUnsafe();
-            auto& group = groups.at(key);
-            auto groupLength = group[index]->length();
-            auto lastIndex = groupLength - 1;
-            return ReturnOrThrowOnFailure(group[index]->GetScalar(lastIndex));
-        });
+arrow::Result<arrow::ArrayVector> GroupBy::hashKernels(
+    std::vector<std::string> const& functions,
+    arrow::ArrayVector const& values,
+    std::shared_ptr<arrow::compute::FunctionOptions> const& options) const
+{
+    std::vector<arrow::Datum> arguments;
+    std::vector<arrow::compute::Aggregate> aggregates;
+    for (size_t i = 0; i < functions.size(); ++i)
+    {
+        aggregates.emplace_back(
+            "hash_" + functions[i],
+            options,
+            arrow::FieldRef{ static_cast<int>(i) },
+            functions[i] + std::to_string(i));
+        arguments.emplace_back(values[i]);
+    }
 
-    ARROW_ASSIGN_OR_RAISE(auto data, buildArray(result));
-    return pd::Series(data, nullptr);
+    // keyed by the ids instead of the key column: hashing uint32 is cheap,
+    // and as the ids are numbered by first appearance the output rows come
+    // out in group id order
+    ARROW_ASSIGN_OR_RAISE(
+        auto result,
+        arrow::compute::internal::GroupBy(arguments, { groupIds }, aggregates));
+
+    auto const& fields = result.array_as<arrow::StructArray>()->fields();
+    arrow::ArrayVector columns(fields.begin(), fields.begin() + functions.size());
+    for (auto& col : columns)
+    {
+        // tdigest answers a list of quantiles per group, a single one by default
+        if (col->type_id() == arrow::Type::FIXED_SIZE_LIST)
+        {
+            auto list = std::static_pointer_cast<arrow::FixedSizeListArray>(col);
+            if (list->list_type()->list_size() == 1)
+            {
+                col = list->values()->Slice(list->offset(), list->length());
+            }
+        }
+    }
+    return columns;
 }
 
-arrow::Result<pd::DataFrame> GroupBy::mode(
-    std::vector<std::string> const& args)
+arrow::Result<pd::DataFrame> GroupBy::agg(
+    std::vector<std::pair<std::string, std::vector<std::string>>> const&
+        aggregations)
 {
-    auto schema = df.m_array->schema();
-    auto N = groups.size();
+    std::vector<std::string> names;
+    arrow::ArrayVector columns;
+    std::vector<size_t> viaKernels;
+    std::vector<std::string> kernelFunctions;
+    arrow::ArrayVector kernelValues;
+    for (auto const& aggregation : aggregations)
+    {
+        auto const& arg = aggregation.first;
+        ARROW_ASSIGN_OR_RAISE(auto values, column(arg));
 
-    auto fv = fieldVectors(args, schema);
-    arrow::ArrayDataVector arr(args.size());
+        std::vector<std::string> functions;
+        for (auto const& function : aggregation.second)
+        {
+            functions.push_back(
+                function == "std"   ? "stddev"
+                    : function == "var" ? "variance"
+                                        : function);
+            names.push_back(
+                aggregation.second.size() == 1 ? arg : arg + "_" + function);
+        }
 
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, args.size()),
-        [&](const tbb::blocked_range<size_t>& r)
+        // the statistics of one column share a single pass over it
+        ARROW_ASSIGN_OR_RAISE(auto reduced, reducer->reduce(functions, *values));
+        for (size_t i = 0; i < functions.size(); ++i)
         {
-            for (size_t i = r.begin(); i != r.end(); ++i)
+            if (reduced[i] == nullptr and
+                (functions[i] == "first" or functions[i] == "last"))
             {
-                const auto& arg = args[i];
-                long L = uniqueKeys->length();
-                int index = schema->GetFieldIndex(arg);
-
-                arrow::ScalarVector result(L);
-                tbb::parallel_for(
-                    tbb::blocked_range<size_t>(0, uniqueKeys->length()),
-                    [&](const tbb::blocked_range<size_t>& r)
-                    {
-                        for (size_t j = r.begin(); j != r.end(); ++j)
-                        {
-                            auto key = uniqueKeys->GetScalar(long(j))
-                                           .MoveValueUnsafe();
-                            auto& group = groups.at(key);
-
-                            arrow::Datum d = ReturnOrThrowOnFailure(
-                                arrow::compute::Mode(group[index]));
-                            result[j] = d.scalar();
-                        }
-                    });
-                ARROW_ASSIGN_OR_RAISE(arr[i], buildData(result));
+                ARROW_ASSIGN_OR_RAISE(
+                    reduced[i],
+                    arrow::compute::Take(
+                        *values,
+                        *boundaryRows(functions[i] == "last")));
             }
-        });
+            else if (reduced[i] == nullptr and functions[i] == "mode")
+            {
+                ARROW_ASSIGN_OR_RAISE(reduced[i], modeOf(arg));
+            }
+            else if (reduced[i] == nullptr)
+            {
+                viaKernels.push_back(columns.size());
+                kernelFunctions.push_back(functions[i]);
+                kernelValues.push_back(values);
+            }
+            columns.push_back(reduced[i]);
+        }
+    }
 
-    return pd::DataFrame(arrow::schema(fv), long(N), arr);
+    // everything else goes through one pass of arrow's kernels
+    if (not kernelFunctions.empty())
+    {
+        ARROW_ASSIGN_OR_RAISE(
+            auto results,
+            hashKernels(kernelFunctions, kernelValues));
+        for (size_t i = 0; i < viaKernels.size(); ++i)
+        {
+            columns[viaKernels[i]] = results[i];
+        }
+    }
+    return makeFrame(names, columns);
 }
 
-arrow::Result<pd::Series> GroupBy::mode(std::string const& arg)
+arrow::Result<std::pair<std::shared_ptr<arrow::Array>, std::vector<int64_t>>>
+GroupBy::sortedByGroup(std::string const& arg) const
 {
-    auto schema = df.m_array->schema();
-    auto N = groups.size();
+    using namespace arrow::compute;
+
+    ARROW_ASSIGN_OR_RAISE(auto values, column(arg));
+    auto batch = arrow::RecordBatch::Make(
+        arrow::schema({ arrow::field("group", arrow::uint32()),
+                        arrow::field("value", values->type()) }),
+        values->length(),
+        arrow::ArrayVector{ groupIds, values });
+
+    ARROW_ASSIGN_OR_RAISE(
+        auto indices,
+        SortIndices(
+            arrow::Datum{ batch },
+            SortOptions{ { SortKey{ "group" }, SortKey{ "value" } },
+                         NullPlacement::AtEnd }));
+    ARROW_ASSIGN_OR_RAISE(auto sorted, Take(*values, *indices));
+
+    std::vector<int64_t> offsets(groupSize() + 1, 0);
+    auto ids = groupIds->raw_values();
+    for (int64_t row = 0; row < groupIds->length(); ++row)
+    {
+        offsets[ids[row] + 1]++;
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
 
-    auto fv = schema->GetFieldByName(arg);
+    return std::pair{ sorted, std::move(offsets) };
+}
+
+std::shared_ptr<arrow::Array> GroupBy::boundaryRows(bool last) const
+{
+    if (not runs.empty())
+    {
+        std::vector<int64_t> rows(groupSize());
+        for (size_t group = 0; group < rows.size(); ++group)
+        {
+            rows[group] = last ? runs[group + 1] - 1 : runs[group];
+        }
+        return arrow::ArrayT<int64_t>::Make(rows);
+    }
 
-    long L = uniqueKeys->length();
-    int index = schema->GetFieldIndex(arg);
+    std::vector<int64_t> rows(groupSize(), -1);
+    auto ids = groupIds->raw_values();
+    for (int64_t row = 0; row < groupIds->length(); ++row)
+    {
+        auto& boundary = rows[ids[row]];
+        if (last or boundary == -1)
+        {
+            boundary = row;
+        }
+    }
+    return arrow::ArrayT<int64_t>::Make(rows);
+}
 
-    arrow::ScalarVector result(L);
+arrow::Result<std::shared_ptr<arrow::Array>> GroupBy::modeOf(
+    std::string const& arg) const
+{
+    ARROW_ASSIGN_OR_RAISE(auto sorted, sortedByGroup(arg));
+    auto const& values = sorted.first;
+    auto const& offsets = sorted.second;
+
+    // the longest run of equal values in each sorted group, the smallest
+    // value wins a tie
+    ::int64_t N = groupSize();
+    std::vector<int64_t> positions(N, -1);
     tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, L),
-        [&](const tbb::blocked_range<size_t>& r)
+        0L,
+        N,
+        [&](::int64_t group)
         {
-            for (size_t j = r.begin(); j != r.end(); ++j)
+            auto end = offsets[group + 1];
+            int64_t bestCount = 0;
+            for (auto i = offsets[group]; i < end and values->IsValid(i);)
             {
-                auto key = uniqueKeys->GetScalar(long(j)).MoveValueUnsafe();
-                auto& group = groups.at(key);
-
-                arrow::Datum d = ReturnOrThrowOnFailure(
-                    arrow::compute::Mode(group[index]));
-                result[j] = d.scalar();
+                auto j = i + 1;
+                while (j < end and values->IsValid(j) and
+                       values->RangeEquals(i, i + 1, j, values))
+                {
+                    j++;
+                }
+                if (j - i > bestCount)
+                {
+                    positions[group] = i;
+                    bestCount = j - i;
+                }
+                i = j;
             }
         });
 
-    ARROW_ASSIGN_OR_RAISE(auto data, buildArray(result));
-    return pd::Series(data, nullptr);
+    std::vector<bool> valid(N);
+    std::ranges::transform(
+        positions,
+        valid.begin(),
+        [](int64_t position) { return position != -1; });
+    return arrow::compute::Take(
+        *values,
+        *arrow::ArrayT<int64_t>::Make(positions, valid));
 }
 
-arrow::Result<pd::DataFrame> GroupBy::quantile(
-    std::vector<std::string> const& args,
-    std::vector<double> const& q)
+arrow::Result<std::shared_ptr<arrow::Array>> GroupBy::quantileOf(
+    std::string const& arg,
+    double q) const
 {
-    auto schema = df.m_array->schema();
-    auto N = groups.size();
-
-    auto fv = fieldVectors(args, schema);
-    arrow::ArrayDataVector arr(args.size());
+    if (q < 0 or q > 1)
+    {
+        return arrow::Status::Invalid("quantile must be in [0, 1], got ", q);
+    }
 
-    auto options =
-        convertToArrowFunctionOptions<arrow::compute::QuantileOptions>(q);
+    ARROW_ASSIGN_OR_RAISE(auto sorted, sortedByGroup(arg));
+    auto const& values = sorted.first;
+    auto const& offsets = sorted.second;
+    ARROW_ASSIGN_OR_RAISE(
+        auto asDouble,
+        arrow::compute::Cast(*values, arrow::float64()));
+    auto const& doubles = static_cast<arrow::DoubleArray const&>(*asDouble);
+
+    // linear interpolation between the closest ranks, like arrow's quantile.
+    // nulls and NaN sort last in a group and are skipped
+    ::int64_t N = groupSize();
+    std::vector<double> result(N);
+    std::vector<char> found(N);
     tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, args.size()),
-        [&](const tbb::blocked_range<size_t>& r)
+        0L,
+        N,
+        [&](::int64_t group)
         {
-            for (size_t i = r.begin(); i != r.end(); ++i)
+            auto begin = offsets[group];
+            auto n = 0L;
+            while (begin + n < offsets[group + 1] and doubles.IsValid(begin + n) and
+                   not std::isnan(doubles.Value(begin + n)))
             {
-                const auto& arg = args[i];
-                long L = uniqueKeys->length();
-                int index = schema->GetFieldIndex(arg);
-
-                arrow::ScalarVector result(L);
-                tbb::parallel_for(
-                    tbb::blocked_range<size_t>(0, uniqueKeys->length()),
-                    [&](const tbb::blocked_range<size_t>& r)
-                    {
-                        for (size_t j = r.begin(); j != r.end(); ++j)
-                        {
-                            auto key = uniqueKeys->GetScalar(long(j))
-                                           .MoveValueUnsafe();
-                            auto& group = groups.at(key);
-
-                            arrow::Datum d =
-                                ReturnOrThrowOnFailure(arrow::compute::Quantile(
-                                    group[index],
-                                    options[i]));
-                            result[j] = d.scalar();
-                        }
-                    });
-                ARROW_ASSIGN_OR_RAISE(arr[i], buildData(result));
+                n++;
+            }
+            if (n == 0)
+            {
+                return;
             }
+            auto position = q * static_cast<double>(n - 1);
+            auto lower = static_cast<int64_t>(std::floor(position));
+            auto upper = static_cast<int64_t>(std::ceil(position));
+            auto low = doubles.Value(begin + lower);
+            result[group] =
+                low + (position - lower) * (doubles.Value(begin + upper) - low);
+            found[group] = true;
         });
 
-    return pd::DataFrame(arrow::schema(fv), long(N), arr);
+    return arrow::ArrayT<double>::Make(
+        result,
+        std::vector<bool>(found.begin(), found.end()));
 }
 
-arrow::Result<pd::Series> GroupBy::quantile(std::string const& arg, double q)
+pd::DataFrame GroupBy::makeFrame(
+    std::vector<std::string> const& names,
+    arrow::ArrayVector const& columns) const
 {
-    auto schema = df.m_array->schema();
-    auto N = groups.size();
+    arrow::FieldVector fields(names.size());
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        fields[i] = arrow::field(names[i], columns[i]->type());
+    }
+    return pd::DataFrame{ arrow::RecordBatch::Make(
+                              arrow::schema(fields),
+                              static_cast<int64_t>(groupSize()),
+                              columns),
+                          uniqueKeys };
+}
 
-    auto fv = schema->GetFieldByName(arg);
+arrow::Result<pd::DataFrame> GroupBy::min_max(
+    std::vector<std::string> const& args)
+{
+    ARROW_ASSIGN_OR_RAISE(auto columns, hashAggregate("min_max", args));
 
-    long L = uniqueKeys->length();
-    int index = schema->GetFieldIndex(arg);
+    std::vector<std::string> names;
+    arrow::ArrayVector minMax;
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        auto const& minMaxStruct =
+            static_cast<arrow::StructArray const&>(*columns[i]);
+        names.push_back(args[i] + "_min");
+        minMax.push_back(minMaxStruct.field(0));
+        names.push_back(args[i] + "_max");
+        minMax.push_back(minMaxStruct.field(1));
+    }
+    return makeFrame(names, minMax);
+}
 
-    arrow::compute::QuantileOptions option(q);
+arrow::Result<pd::DataFrame> GroupBy::min_max(std::string const& arg)
+{
+    ARROW_ASSIGN_OR_RAISE(auto columns, hashAggregate("min_max", { arg }));
+    auto const& minMaxStruct = static_cast<arrow::StructArray const&>(*columns[0]);
+    return makeFrame(
+        { "min", "max" },
+        { minMaxStruct.field(0), minMaxStruct.field(1) });
+}
 
-    arrow::ScalarVector result(L);
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, L),
-        [&](const tbb::blocked_range<size_t>& r)
-        {
-            for (size_t j = r.begin(); j != r.end(); ++j)
-            {
-                auto key = uniqueKeys->GetScalar(long(j)).MoveValueUnsafe();
-                auto& group = groups.at(key);
+arrow::Result<pd::DataFrame> GroupBy::first(
+    std::vector<std::string> const& args)
+{
+    auto rows = boundaryRows(false);
+    arrow::ArrayVector columns(args.size());
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        ARROW_ASSIGN_OR_RAISE(auto values, column(args[i]));
+        ARROW_ASSIGN_OR_RAISE(columns[i], arrow::compute::Take(*values, *rows));
+    }
+    return makeFrame(args, columns);
+}
 
-                arrow::Datum d = ReturnOrThrowOnFailure(
-                    arrow::compute::Quantile(group[index], option));
-                result[j] = d.scalar();
-            }
-        });
+arrow::Result<pd::Series> GroupBy::first(std::string const& arg)
+{
+    ARROW_ASSIGN_OR_RAISE(auto values, column(arg));
+    ARROW_ASSIGN_OR_RAISE(
+        auto data,
+        arrow::compute::Take(*values, *boundaryRows(false)));
+    return pd::Series(data, uniqueKeys, arg);
+}
+
+arrow::Result<pd::DataFrame> GroupBy::last(
+    std::vector<std::string> const& args)
+{
+    auto rows = boundaryRows(true);
+    arrow::ArrayVector columns(args.size());
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        ARROW_ASSIGN_OR_RAISE(auto values, column(args[i]));
+        ARROW_ASSIGN_OR_RAISE(columns[i], arrow::compute::Take(*values, *rows));
+    }
+    return makeFrame(args, columns);
+}
 
-    ARROW_ASSIGN_OR_RAISE(auto data, buildArray(result));
-    return pd::Series(data, nullptr);
+arrow::Result<pd::Series> GroupBy::last(
+    std::string const& arg)
+{
+    ARROW_ASSIGN_OR_RAISE(auto values, column(arg));
+    ARROW_ASSIGN_OR_RAISE(
+        auto data,
+        arrow::compute::Take(*values, *boundaryRows(true)));
+    return pd::Series(data, uniqueKeys, arg);
+}
+
+arrow::Result<pd::DataFrame> GroupBy::mode(
+    std::vector<std::string> const& args)
+{
+    arrow::ArrayVector columns(args.size());
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        ARROW_ASSIGN_OR_RAISE(columns[i], modeOf(args[i]));
+    }
+    return makeFrame(args, columns);
+}
+
+arrow::Result<pd::Series> GroupBy::mode(std::string const& arg)
+{
+    ARROW_ASSIGN_OR_RAISE(auto data, modeOf(arg));
+    return pd::Series(data, uniqueKeys, arg);
+}
+
+arrow::Result<pd::DataFrame> GroupBy::quantile(
+    std::vector<std::string> const& args,
+    std::vector<double> const& q)
+{
+    if (q.size() != args.size())
+    {
+        return arrow::Status::Invalid("quantile expects one q per column");
+    }
+
+    arrow::ArrayVector columns(args.size());
+    for (size_t i = 0; i < args.size(); i++)
+    {
+        ARROW_ASSIGN_OR_RAISE(columns[i], quantileOf(args[i], q[i]));
+    }
+    return makeFrame(args, columns);
+}
+
+arrow::Result<pd::Series> GroupBy::quantile(std::string const& arg, double q)
+{
+    ARROW_ASSIGN_OR_RAISE(auto data, quantileOf(arg, q));
+    return pd::Series(data, uniqueKeys, arg);
 }
 }
\ No newline at end of file
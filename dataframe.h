@@ -3,6 +3,9 @@
 //
 #pragma once
 #include "filesystem"
+#include <optional>
+#include <arrow/compute/exec/expression.h>
+#include <arrow/util/compression.h>
 #include "ndframe.h"
 #include "tabulate/table.hpp"
 
@@ -11,6 +14,50 @@ namespace pd {
     constexpr int PD_MAX_ROW_TO_PRINT = {100};
     constexpr int PD_MAX_COL_TO_PRINT = {10};
 
+    /// Controls how DataFrame::readParquet and DataFrame::readParquetBatches
+    /// decode a file.
+    struct ParquetReadOptions
+    {
+        /// rows per streamed batch, 0 streams one batch per row group
+        int64_t batch_size{ 0 };
+        /// decode the next batch on a background thread while the current
+        /// one is being processed
+        bool prefetch{ true };
+        /// decode the columns of a row group in parallel
+        bool use_threads{ true };
+        /// top-level columns to load, in output order, each once. empty loads
+        /// every column
+        std::vector<std::string> columns{};
+        /// row predicate, e.g.
+        /// and_(greater_equal(field_ref("ts"), literal(x)),
+        ///      is_in(field_ref("symbol"), SetLookupOptions{symbols})).
+        /// row groups whose min/max statistics cannot satisfy it are skipped
+        /// before any page is decoded, the remaining rows are filtered after
+        std::optional<arrow::compute::Expression> filter{};
+    };
+
+    /// Controls how DataFrame::toParquet encodes a file.
+    struct ParquetWriteOptions
+    {
+        /// maximum rows per row group
+        int64_t row_group_size{ 1 << 20 };
+        arrow::Compression::type compression{ arrow::Compression::UNCOMPRESSED };
+        /// column name -> codec, overrides compression
+        std::unordered_map<std::string, arrow::Compression::type> column_compression{};
+        bool dictionary{ true };
+        /// column name -> dictionary encoding on/off, overrides dictionary
+        std::unordered_map<std::string, bool> column_dictionary{};
+        /// write min/max/null count statistics used for row group pruning
+        bool statistics{ true };
+        /// encode the columns of a row group in parallel
+        bool use_threads{ true };
+        /// name of the column the index is stored in, "__index_level_0__" by
+        /// default. it must not be the name of a column of the frame
+        std::optional<std::string> index_name{};
+    };
+
+    class DataFrameBatchReader;
+
     class DataFrame : public NDFrame<DataFrame>{
     public:
 
@@ -135,7 +182,37 @@ namespace pd {
         DataFrame describe(bool include_all=true,
                            bool percentiles=false);
 
-        static DataFrame readParquet(std::filesystem::path const &path);
+        static DataFrame readParquet(std::filesystem::path const &path,
+                                     ParquetReadOptions const& options={});
+
+        static DataFrameBatchReader readParquetBatches(
+            std::filesystem::path const &path,
+            ParquetReadOptions const& options={});
+
+        /// writes the frame and its index, readParquet restores the index
+        void toParquet(std::filesystem::path const &path,
+                       ParquetWriteOptions const& options={}) const;
+
+        /// reads an Arrow IPC (Feather v2) file written by toFeather. with
+        /// mmap the columns reference the mapped file instead of being copied.
+        static DataFrame readFeather(std::filesystem::path const &path,
+                                     bool mmap=true);
+
+        /// writes the frame and its index uncompressed in the Arrow IPC file
+        /// format, so readFeather can map it back without decoding. index_name
+        /// as in ParquetWriteOptions
+        void toFeather(std::filesystem::path const &path,
+                       std::optional<std::string> const& index_name={}) const;
+
+        /// evaluates a string expression such as "c = (a + b) / d" over
+        /// the columns, see parseExpression. The result is stored in the
+        /// assigned column (added or replaced), or in a column named after
+        /// the expression when there is no assignment.
+        [[nodiscard]] DataFrame eval(std::string const& expression) const;
+
+        /// rows where a boolean string expression such as
+        /// "price > 10 and qty < 5" holds, nulls count as false
+        [[nodiscard]] DataFrame query(std::string const& expression) const;
 
         // indexer
         class Series operator[](std::string const &column) const;
@@ -150,13 +227,25 @@ namespace pd {
             return at(row, m_array->schema()->GetFieldIndex(col));
         }
 
-        pd::DataFrame reindex(std::shared_ptr<arrow::Array> const&newIndex) const noexcept;
+        /// the rows at the labels of newIndex, null where a label is not in
+        /// the index. labels of another type are cast to the index type first
+        pd::DataFrame reindex(std::shared_ptr<arrow::Array> const&newIndex) const;
 
-        pd::DataFrame reindexAsync(std::shared_ptr<arrow::Array> const&newIndex) const noexcept;
+        /// reindex taking the columns in parallel
+        pd::DataFrame reindexAsync(std::shared_ptr<arrow::Array> const&newIndex) const;
 
         Scalar at(std::shared_ptr<arrow::Scalar> const& row,
                   std::string const& col) const
         {
+            if (auto rangeIndex = RangeIndex::of(m_index))
+            {
+                auto position = rangeIndex->position(*row);
+                if (not position)
+                {
+                    throw std::runtime_error(row->ToString() + " is not in the index");
+                }
+                return at(*position, col);
+            }
             return at(
                 arrow::compute::Index(
                     m_index,
@@ -208,9 +297,12 @@ namespace pd {
 
         [[nodiscard]] Scalar sum() const;
 
+        /// defers the arithmetic chained on the result, see LazyFrame
+        [[nodiscard]] class LazyFrame lazy() const;
+
         bool equals_(DataFrame const& other) const override
         {
-            return m_array->Equals(*other.m_array) && m_index->Equals(other.indexArray());
+            return m_array->Equals(*other.m_array) && indexEquals(m_index, other.indexArray());
         }
 
         template<typename T> requires (not std::same_as<DataFrame, T>)
@@ -340,6 +432,23 @@ namespace pd {
 
         DataFrame operator*(Scalar const &a) const;
 
+        /// compound assignment, each column is written into its own buffers
+        /// when only this frame references them and the result keeps the
+        /// type, any other column is replaced as by df = df + a. The index
+        /// is kept
+        DataFrame& operator+=(DataFrame const &a);
+        DataFrame& operator+=(Series const &a);
+        DataFrame& operator+=(Scalar const &a);
+        DataFrame& operator-=(DataFrame const &a);
+        DataFrame& operator-=(Series const &a);
+        DataFrame& operator-=(Scalar const &a);
+        DataFrame& operator*=(DataFrame const &a);
+        DataFrame& operator*=(Series const &a);
+        DataFrame& operator*=(Scalar const &a);
+        DataFrame& operator/=(DataFrame const &a);
+        DataFrame& operator/=(Series const &a);
+        DataFrame& operator/=(Scalar const &a);
+
         friend DataFrame operator+(Scalar const &a, DataFrame const &b);
 
         friend DataFrame operator/(Scalar const &a, DataFrame const &b);
@@ -383,7 +492,9 @@ namespace pd {
                               bool ascending=true,
                               bool ignore_index=false);
 
-        [[nodiscard]] class GroupBy group_by(std::string const&) const;
+        /// sorted asserts that equal keys are adjacent, see GroupBy
+        [[nodiscard]] class GroupBy group_by(std::string const&, bool sorted = false) const;
+        [[nodiscard]] class GroupBy group_by(std::vector<std::string> const& keys, bool sorted = false) const;
         [[nodiscard]] class Resampler resample(std::string const& rule,
                                                bool closed_right = false,
                                                bool label_right = false,
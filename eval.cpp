@@ -0,0 +1,483 @@
+//
+// Created by dewe on 10/17/26.
+//
+#include "eval.h"
+#include <algorithm>
+#include <arrow/compute/api.h>
+#include <cctype>
+#include <mutex>
+#include <tbb/parallel_for.h>
+#include "dataframe.h"
+#include "parallel.h"
+
+
+namespace pd {
+
+namespace cp = arrow::compute;
+
+// bound expressions kept by bindExpression before the cache is reset
+constexpr size_t PD_EXPRESSION_CACHE_SIZE = { 1024 };
+
+namespace {
+
+struct Token
+{
+    enum class Kind
+    {
+        Number,
+        String,
+        Identifier,
+        Operator,
+        End
+    };
+
+    Kind kind{ Kind::End };
+    std::string text;
+};
+
+std::vector<Token> tokenize(std::string const& text)
+{
+    std::vector<Token> tokens;
+    size_t i = 0;
+    while (i < text.size())
+    {
+        char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c)))
+        {
+            i++;
+        }
+        else if (std::isdigit(static_cast<unsigned char>(c)) or
+                 (c == '.' and i + 1 < text.size() and
+                  std::isdigit(static_cast<unsigned char>(text[i + 1]))))
+        {
+            size_t end = i;
+            while (end < text.size() and
+                   (std::isalnum(static_cast<unsigned char>(text[end])) or
+                    text[end] == '.' or
+                    ((text[end] == '+' or text[end] == '-') and
+                     (text[end - 1] == 'e' or text[end - 1] == 'E'))))
+            {
+                end++;
+            }
+            tokens.push_back({ Token::Kind::Number, text.substr(i, end - i) });
+            i = end;
+        }
+        else if (std::isalpha(static_cast<unsigned char>(c)) or c == '_')
+        {
+            size_t end = i;
+            while (end < text.size() and
+                   (std::isalnum(static_cast<unsigned char>(text[end])) or
+                    text[end] == '_'))
+            {
+                end++;
+            }
+            tokens.push_back({ Token::Kind::Identifier, text.substr(i, end - i) });
+            i = end;
+        }
+        else if (c == '`' or c == '\'' or c == '"')
+        {
+            auto end = text.find(c, i + 1);
+            if (end == std::string::npos)
+            {
+                throw std::runtime_error(
+                    "cannot parse expression '" + text + "': unterminated " + c);
+            }
+            tokens.push_back(
+                { c == '`' ? Token::Kind::Identifier : Token::Kind::String,
+                  text.substr(i + 1, end - i - 1) });
+            i = end + 1;
+        }
+        else
+        {
+            static const std::vector<std::string> operators{
+                "<=", ">=", "==", "!=", "<", ">", "=", "+", "-",
+                "*",  "/",  "(",  ")",  "&", "|", "~"
+            };
+            auto it = std::ranges::find_if(
+                operators,
+                [&](std::string const& op)
+                { return text.compare(i, op.size(), op) == 0; });
+            if (it == operators.end())
+            {
+                throw std::runtime_error(
+                    "cannot parse expression '" + text +
+                    "': unexpected character '" + c + "'");
+            }
+            tokens.push_back({ Token::Kind::Operator, *it });
+            i += it->size();
+        }
+    }
+    tokens.push_back({ Token::Kind::End, "" });
+    return tokens;
+}
+
+/// recursive descent, lowest precedence first:
+/// or > and > not > comparison > + - > * / > unary minus > primary
+class Parser
+{
+public:
+    explicit Parser(std::string const& text)
+        : m_text(text), m_tokens(tokenize(text))
+    {
+    }
+
+    ParsedExpression parse()
+    {
+        ParsedExpression result;
+        if (m_tokens.size() > 2 and
+            m_tokens[0].kind == Token::Kind::Identifier and
+            m_tokens[1].kind == Token::Kind::Operator and
+            m_tokens[1].text == "=")
+        {
+            result.target = m_tokens[0].text;
+            m_pos = 2;
+        }
+
+        result.expression = parseOr();
+        if (peek().kind != Token::Kind::End)
+        {
+            fail("unexpected '" + peek().text + "'");
+        }
+        return result;
+    }
+
+private:
+    std::string const& m_text;
+    std::vector<Token> m_tokens;
+    size_t m_pos{ 0 };
+
+    Token const& peek() const
+    {
+        return m_tokens[m_pos];
+    }
+
+    bool accept(std::string const& op)
+    {
+        auto const& token = peek();
+        bool matches =
+            (token.kind == Token::Kind::Operator and token.text == op) or
+            (token.kind == Token::Kind::Identifier and token.text == op and
+             (op == "and" or op == "or" or op == "not"));
+        if (matches)
+        {
+            m_pos++;
+        }
+        return matches;
+    }
+
+    [[noreturn]] void fail(std::string const& reason) const
+    {
+        throw std::runtime_error(
+            "cannot parse expression '" + m_text + "': " + reason);
+    }
+
+    cp::Expression parseOr()
+    {
+        auto lhs = parseAnd();
+        while (accept("or") or accept("|"))
+        {
+            lhs = cp::or_(lhs, parseAnd());
+        }
+        return lhs;
+    }
+
+    cp::Expression parseAnd()
+    {
+        auto lhs = parseNot();
+        while (accept("and") or accept("&"))
+        {
+            lhs = cp::and_(lhs, parseNot());
+        }
+        return lhs;
+    }
+
+    cp::Expression parseNot()
+    {
+        if (accept("not") or accept("~"))
+        {
+            return cp::not_(parseNot());
+        }
+        return parseComparison();
+    }
+
+    cp::Expression parseComparison()
+    {
+        auto lhs = parseSum();
+        static const std::vector<std::pair<std::string, std::string>>
+            comparisons{ { "<=", "less_equal" },   { ">=", "greater_equal" },
+                         { "==", "equal" },        { "!=", "not_equal" },
+                         { "<", "less" },          { ">", "greater" } };
+        for (auto const& [op, function] : comparisons)
+        {
+            if (accept(op))
+            {
+                return cp::call(function, { lhs, parseSum() });
+            }
+        }
+        return lhs;
+    }
+
+    cp::Expression parseSum()
+    {
+        auto lhs = parseProduct();
+        while (true)
+        {
+            if (accept("+"))
+            {
+                lhs = cp::call("add", { lhs, parseProduct() });
+            }
+            else if (accept("-"))
+            {
+                lhs = cp::call("subtract", { lhs, parseProduct() });
+            }
+            else
+            {
+                return lhs;
+            }
+        }
+    }
+
+    cp::Expression parseProduct()
+    {
+        auto lhs = parseUnary();
+        while (true)
+        {
+            if (accept("*"))
+            {
+                lhs = cp::call("multiply", { lhs, parseUnary() });
+            }
+            else if (accept("/"))
+            {
+                lhs = cp::call("divide", { lhs, parseUnary() });
+            }
+            else
+            {
+                return lhs;
+            }
+        }
+    }
+
+    cp::Expression parseUnary()
+    {
+        if (accept("-"))
+        {
+            return cp::call("negate", { parseUnary() });
+        }
+        if (accept("+"))
+        {
+            return parseUnary();
+        }
+        return parsePrimary();
+    }
+
+    cp::Expression parsePrimary()
+    {
+        auto token = peek();
+        switch (token.kind)
+        {
+            case Token::Kind::Number:
+            {
+                m_pos++;
+                try
+                {
+                    size_t used = 0;
+                    if (token.text.find_first_of(".eE") == std::string::npos)
+                    {
+                        auto value = std::stoll(token.text, &used);
+                        if (used == token.text.size())
+                        {
+                            return cp::literal(static_cast<int64_t>(value));
+                        }
+                    }
+                    else
+                    {
+                        auto value = std::stod(token.text, &used);
+                        if (used == token.text.size())
+                        {
+                            return cp::literal(value);
+                        }
+                    }
+                }
+                catch (std::logic_error const&)
+                {
+                }
+                fail("invalid number '" + token.text + "'");
+            }
+            case Token::Kind::String:
+                m_pos++;
+                return cp::literal(token.text);
+            case Token::Kind::Identifier:
+                m_pos++;
+                if (token.text == "true" or token.text == "True")
+                {
+                    return cp::literal(true);
+                }
+                if (token.text == "false" or token.text == "False")
+                {
+                    return cp::literal(false);
+                }
+                return cp::field_ref(token.text);
+            case Token::Kind::Operator:
+                if (accept("("))
+                {
+                    auto inner = parseOr();
+                    if (not accept(")"))
+                    {
+                        fail("missing ')'");
+                    }
+                    return inner;
+                }
+                break;
+            case Token::Kind::End:
+                fail("unexpected end");
+        }
+        fail("unexpected '" + token.text + "'");
+    }
+};
+
+/// parses and binds text against schema once, later calls with the same
+/// text and schema reuse the bound expression
+ParsedExpression bindExpression(std::string const& text, arrow::Schema const& schema)
+{
+    static std::mutex mutex;
+    static std::unordered_map<std::string, ParsedExpression> cache;
+
+    auto fingerprint = schema.fingerprint();
+    auto key = (fingerprint.empty() ? schema.ToString() : fingerprint) + '\n' + text;
+    {
+        std::lock_guard lock(mutex);
+        if (auto it = cache.find(key); it != cache.end())
+        {
+            return it->second;
+        }
+    }
+
+    auto parsed = parseExpression(text);
+    parsed.expression =
+        ReturnOrThrowOnFailure(parsed.expression.Bind(schema));
+
+    std::lock_guard lock(mutex);
+    if (cache.size() >= PD_EXPRESSION_CACHE_SIZE)
+    {
+        cache.clear();
+    }
+    cache.emplace(key, parsed);
+    return parsed;
+}
+
+/// the expression over rows [offset, offset + length) of batch
+std::shared_ptr<arrow::Array> evaluateSlice(
+    cp::Expression const& bound,
+    std::shared_ptr<arrow::RecordBatch> const& batch,
+    int64_t offset,
+    int64_t length)
+{
+    auto slice = batch->Slice(offset, length);
+    auto result = ReturnOrThrowOnFailure(
+        cp::ExecuteScalarExpression(bound, cp::ExecBatch(*slice)));
+    if (result.is_scalar())
+    {
+        return ReturnOrThrowOnFailure(
+            arrow::MakeArrayFromScalar(*result.scalar(), length));
+    }
+    return result.make_array();
+}
+
+/// runs fn(morsel, offset, length) for every PD_MORSEL_SIZE rows in parallel,
+/// returns the number of morsels
+template<class Fn>
+int64_t forEachMorsel(int64_t num_rows, Fn&& fn)
+{
+    auto numMorsels =
+        std::max<int64_t>(1, (num_rows + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE);
+    tbb::parallel_for(
+        int64_t{ 0 },
+        numMorsels,
+        [&](int64_t morsel)
+        {
+            auto offset = morsel * PD_MORSEL_SIZE;
+            fn(morsel, offset, std::min(PD_MORSEL_SIZE, num_rows - offset));
+        });
+    return numMorsels;
+}
+
+}
+
+ParsedExpression parseExpression(std::string const& text)
+{
+    return Parser{ text }.parse();
+}
+
+DataFrame DataFrame::eval(std::string const& expression) const
+{
+    auto parsed = bindExpression(expression, *m_array->schema());
+    auto num_rows = m_array->num_rows();
+
+    // every morsel evaluates the whole tree, the temporaries stay morsel sized
+    arrow::ArrayVector parts(
+        std::max<int64_t>(1, (num_rows + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE));
+    forEachMorsel(
+        num_rows,
+        [&](int64_t morsel, int64_t offset, int64_t length)
+        { parts[morsel] = evaluateSlice(parsed.expression, m_array, offset, length); });
+
+    auto column = parts.size() == 1 ?
+        parts[0] :
+        ReturnOrThrowOnFailure(arrow::Concatenate(parts));
+
+    auto name = parsed.target.value_or(expression);
+    auto field = arrow::field(name, column->type());
+    auto i = m_array->schema()->GetFieldIndex(name);
+    auto batch = i == -1 ?
+        m_array->AddColumn(m_array->num_columns(), field, column) :
+        m_array->SetColumn(i, field, column);
+    return { ReturnOrThrowOnFailure(std::move(batch)), m_index };
+}
+
+DataFrame DataFrame::query(std::string const& expression) const
+{
+    auto parsed = bindExpression(expression, *m_array->schema());
+    if (parsed.target)
+    {
+        throw std::runtime_error(
+            "query expects a condition, got the assignment '" + expression + "'");
+    }
+    if (not parsed.expression.type()->Equals(arrow::boolean()))
+    {
+        throw std::runtime_error(
+            "query condition '" + expression + "' is not boolean but " +
+            parsed.expression.type()->ToString());
+    }
+
+    auto num_rows = m_array->num_rows();
+    auto index = indexArray();
+    auto numMorsels =
+        std::max<int64_t>(1, (num_rows + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE);
+    arrow::RecordBatchVector batches(numMorsels);
+    arrow::ArrayVector indexes(numMorsels);
+
+    // the mask of a morsel is consumed while it is still in cache
+    forEachMorsel(
+        num_rows,
+        [&](int64_t morsel, int64_t offset, int64_t length)
+        {
+            auto mask = evaluateSlice(parsed.expression, m_array, offset, length);
+            batches[morsel] = ReturnOrThrowOnFailure(
+                cp::Filter(m_array->Slice(offset, length), mask))
+                                  .record_batch();
+            indexes[morsel] = ReturnOrThrowOnFailure(
+                cp::Filter(index->Slice(offset, length), mask))
+                                  .make_array();
+        });
+
+    if (numMorsels == 1)
+    {
+        return { batches[0], indexes[0] };
+    }
+    auto table = ReturnOrThrowOnFailure(
+        arrow::Table::FromRecordBatches(m_array->schema(), batches));
+    return { ReturnOrThrowOnFailure(table->CombineChunksToBatch()),
+             ReturnOrThrowOnFailure(arrow::Concatenate(indexes)) };
+}
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+//
+// Created by dewe on 10/17/26.
+//
+#include <arrow/compute/exec/expression.h>
+#include <optional>
+#include <string>
+
+
+namespace pd {
+
+/// A string expression parsed for DataFrame::eval and DataFrame::query.
+struct ParsedExpression
+{
+    /// the assigned column of "name = expression"
+    std::optional<std::string> target;
+    arrow::compute::Expression expression;
+};
+
+/// Parses a pandas style expression into an unbound arrow Expression:
+/// column names (or `quoted names`), integer, float, string and true/false
+/// literals, + - * /, comparisons, and/or/not (also & | ~) and parentheses.
+/// A leading "name =" makes it an assignment. Throws std::runtime_error on
+/// a syntax error.
+ParsedExpression parseExpression(std::string const& text);
+
+}
@@ -6,6 +6,8 @@
 #include <tbb/parallel_for.h>
 #include <arrow/compute/exec/test_util.h>
 
+#include <mutex>
+#include <optional>
 #include <utility>
 #include "unordered_map"
 #include "string"
@@ -14,18 +16,49 @@
 #include "arrow/compute/api_vector.h"
 #include "arrow/compute/row/grouper.h"
 #include "dataframe.h"
+#include "grouping.h"
 #include "series.h"
 
-using GroupMap = std::unordered_map<std::shared_ptr<arrow::Scalar>,
-    arrow::ArrayVector, pd::HashScalar, pd::HashScalar>;
+/// the columns of every group, indexed by group id
+using GroupMap = std::vector<arrow::ArrayVector>;
 
 namespace pd {
 
+struct GroupByRolling;
+
+/// rows of small groups batched into one task of GroupBy::apply_async
+constexpr int64_t PD_APPLY_BATCH_ROWS = { 1 << 12 };
+
+/// Groups the rows of a DataFrame by the values of one or more columns.
+/// Grouping only assigns every row its group id; the aggregations run one
+/// hash_* kernel pass per call over all requested columns and the ids, and
+/// are indexed by the group keys (a struct array for several columns).
+/// group() and apply are the only users of per group slices, which are
+/// split column by column on first use; operator[] narrows the columns
+/// without grouping again.
+///
+/// Sorted keys (a monotonic single integer or temporal key is detected,
+/// sorted = true asserts it) are grouped as runs of equal rows without hashing; their groups are
+/// then zero-copy slices of the columns.
 struct GroupBy
 {
-    GroupBy(std::string key, pd::DataFrame  df) : df(std::move(df))
+    GroupBy(std::string key, pd::DataFrame df, bool sorted = false)
+        : GroupBy(
+              std::vector<std::string>{ std::move(key) },
+              std::move(df),
+              sorted)
     {
-        auto result = makeGroups(std::move(key));
+    }
+
+    /// all key columns go through one arrow Grouper, fixed width keys are
+    /// packed into a single row key instead of being combined as strings
+    GroupBy(
+        std::vector<std::string> const& keys,
+        pd::DataFrame df,
+        bool sorted = false)
+        : df(std::move(df))
+    {
+        auto result = makeGroups(keys, sorted);
         if (not result.ok())
         {
             throw std::runtime_error(result.ToString());
@@ -34,16 +67,18 @@ struct GroupBy
 
     inline size_t groupSize() const
     {
-        return groups.size();
+        return uniqueKeys->length();
     }
 
     template<class T>
-        requires(not std::same_as<T, std::shared_ptr<arrow::Scalar>>)
+        requires(
+            not std::same_as<std::remove_cvref_t<T>, std::shared_ptr<arrow::Scalar>> and
+            not std::same_as<std::remove_cvref_t<T>, arrow::ScalarVector>)
     inline arrow::ArrayVector group(T&& value) const
     {
         try
         {
-            return groups.at(arrow::MakeScalar(std::forward<T>(value)));
+            return groupColumns(keyIndexer.at(arrow::MakeScalar(value)));
         }
         catch (std::out_of_range const& exception)
         {
@@ -52,6 +87,19 @@ struct GroupBy
         }
     }
 
+    /// the same groups over a subset of the columns, sharing the group ids
+    GroupBy operator[](std::vector<std::string> const& columns) const;
+
+    inline GroupBy operator[](std::string const& column) const
+    {
+        return operator[](std::vector<std::string>{ column });
+    }
+
+    /// the group of a multi-column key, one scalar per key column
+    arrow::ArrayVector group(arrow::ScalarVector const& values) const;
+
+    /// the distinct keys in group id order, a struct array with a field per
+    /// key column when grouping by several
     inline std::shared_ptr<arrow::Array> unique() const
     {
         return uniqueKeys;
@@ -68,12 +116,72 @@ struct GroupBy
     arrow::Result<pd::DataFrame> apply(
         std::function<std::shared_ptr<arrow::Scalar>(Series const&)> fn);
 
+    /// apply on tbb: groups are batched by PD_APPLY_BATCH_ROWS rows per task,
+    /// each group is a zero-copy view of the columns split once, and every
+    /// batch appends its results to its own builder
     arrow::Result<pd::Series> apply_async(
         std::function<std::shared_ptr<arrow::Scalar>(DataFrame const&)> fn);
 
     arrow::Result<pd::DataFrame> apply_async(
         std::function<std::shared_ptr<arrow::Scalar>(Series const&)> fn);
 
+    /// the aggregate of arg's group on every row, aligned to the rows and
+    /// index of df, e.g. transform("mean", "px") to demean. function is any
+    /// of the aggregations below returning one value per group
+    arrow::Result<pd::Series> transform(
+        std::string const& function,
+        std::string const& arg);
+
+    /// fn of every group of arg, scattered back to the rows of the group.
+    /// fn returns one value per row of the group, or a single value for the
+    /// whole group
+    arrow::Result<pd::Series> transform(
+        std::function<pd::Series(Series const&)> const& fn,
+        std::string const& arg);
+
+    // window functions within each group, in row order. The rows are
+    // counting sorted by group id once (groupings()), every group is scanned
+    // by the kernel on its own slice in parallel, then scattered back to the
+    // rows and index of df
+    arrow::Result<pd::Series> cumsum(
+        std::string const& arg,
+        bool skip_nulls = true) const;
+    arrow::Result<pd::Series> cumprod(
+        std::string const& arg,
+        bool skip_nulls = true) const;
+    /// groups shorter than |periods| are all fill_value (or null)
+    arrow::Result<pd::Series> shift(
+        std::string const& arg,
+        int32_t periods = 1,
+        std::shared_ptr<arrow::Scalar> const& fill_value = nullptr) const;
+    /// arg minus arg shifted by periods, within each group
+    arrow::Result<pd::Series> diff(
+        std::string const& arg,
+        int32_t periods = 1) const;
+    /// 1 based ranks, nulls last
+    arrow::Result<pd::Series> rank(
+        std::string const& arg,
+        bool ascending = true,
+        arrow::compute::RankOptions::Tiebreaker tiebreaker =
+            arrow::compute::RankOptions::First) const;
+    /// windows of the last window rows of a group, see GroupByRolling.
+    /// minPeriods defaults to window
+    GroupByRolling rolling(
+        int64_t window,
+        std::optional<int64_t> minPeriods = std::nullopt) const;
+
+    /// several aggregations per column in one frame indexed by the keys,
+    /// e.g. agg({ { "px", { "mean", "std", "min", "max" } },
+    ///            { "qty", { "sum", "count" } } })
+    /// The sum, mean, min, max, count, std (stddev) and var (variance) of a
+    /// numeric column come from one fused pass over it; first, last, mode and
+    /// any other hash_* aggregation share one pass of arrow's kernels. A
+    /// column keeps its name unless it is aggregated more than once, then it
+    /// is named column_function
+    arrow::Result<pd::DataFrame> agg(
+        std::vector<std::pair<std::string, std::vector<std::string>>> const&
+            aggregations);
+
     arrow::Result<pd::DataFrame> mean(std::vector<std::string> const& args);
     arrow::Result<pd::Series> mean(std::string const& arg);
 
@@ -141,33 +249,43 @@ protected:
     }
 
 private:
-    GroupMap groups;
-    DataFrame df;
-    std::unordered_map<
-        std::shared_ptr<arrow::Scalar>,
-        std::shared_ptr<arrow::Array>,
-        pd::HashScalar,
-        pd::HashScalar>
-        indexGroups;
-    std::shared_ptr<arrow::Array> uniqueKeys;
+    friend struct GroupByRolling;
 
-    template<typename OptionT, typename... Args>
-    static OptionT convertToArrowFunctionOption(Args const&... args)
+    /// the index and columns of every group, each split on first use
+    struct Slices
     {
-        return OptionT(args...);
-    }
+        explicit Slices(size_t numColumns)
+            : columnBuilt(numColumns), columns(numColumns)
+        {
+        }
 
-    template<typename OptionT, typename Args>
-    static std::vector<OptionT> convertToArrowFunctionOptions(
-        std::vector<Args> const& args)
-    {
-        std::vector<OptionT> options(args.size());
-        std::ranges::transform(
-            args,
-            options.begin(),
-            convertToArrowFunctionOption<OptionT, Args>);
-        return options;
-    }
+        std::once_flag groupingsBuilt;
+        std::shared_ptr<arrow::ListArray> groupings;
+        std::once_flag indexBuilt;
+        arrow::ArrayVector index;
+        std::vector<std::once_flag> columnBuilt;
+        /// per column of df, the slice of every group
+        std::vector<arrow::ArrayVector> columns;
+    };
+
+    DataFrame df;
+    /// the group of every row of df, numbered by first appearance
+    std::shared_ptr<arrow::UInt32Array> groupIds;
+    std::shared_ptr<arrow::Array> uniqueKeys;
+    Indexer keyIndexer;
+    /// the groupSize() + 1 offsets of the groups when each is a run of rows,
+    /// else empty
+    std::vector<int64_t> runs;
+    /// parallel sum/mean/min/max/count/variance/stddev over groupIds
+    std::shared_ptr<GroupReducer> reducer;
+    std::shared_ptr<Slices> groupSlices;
+
+    /// the row positions of every group
+    std::shared_ptr<arrow::ListArray> const& groupings() const;
+    arrow::ArrayVector const& indexSlices() const;
+    arrow::ArrayVector const& columnSlices(int column) const;
+    /// every column of one group
+    arrow::ArrayVector groupColumns(int64_t group) const;
 
     arrow::Result<std::shared_ptr<arrow::ArrayData>> buildData(
         arrow::ScalarVector const& arg)
@@ -199,40 +317,142 @@ private:
         return data;
     }
 
-    static inline auto defaultOpt =
-        std::shared_ptr<arrow::compute::FunctionOptions>();
-
-    /// takes in a grouper (an object that groups rows in a DataFrame based
-    /// on certain criteria), a groupings array (which specifies the groups
-    /// that the rows are grouped into), and a column array (which contains
-    /// the data of a specific column in the DataFrame). It uses the grouper
-    /// to group the rows in the column array based on the groupings, and
-    /// stores the grouped data in the groups attribute.
-    arrow::Status processEach(
-        std::unique_ptr<arrow::compute::Grouper> const& grouper,
-        std::shared_ptr<arrow::ListArray> const& groupings,
-        std::shared_ptr<arrow::Array> const& column);
-
-    /// The processIndex() function takes in the same inputs as processEach(),
-    /// but it is used to group the rows in the index column of the DataFrame,
-    /// rather than a specific column.
-    arrow::Status processIndex(
-        std::unique_ptr<arrow::compute::Grouper> const& grouper,
-        std::shared_ptr<arrow::ListArray> const& groupings);
-
-    arrow::Status makeGroups(std::string const& keyInStringFormat);
-
-    arrow::FieldVector fieldVectors(
+    arrow::Status makeGroups(std::vector<std::string> const& keys, bool sorted);
+
+    /// column split into the slices of every group
+    arrow::ArrayVector splitGroups(arrow::Array const& column) const;
+
+    arrow::Result<std::shared_ptr<arrow::Array>> column(
+        std::string const& name) const;
+
+    /// one value per group for every column of args, from the GroupReducer
+    /// when it covers function, else from hashKernels
+    arrow::Result<arrow::ArrayVector> hashAggregate(
+        std::string const& function,
         std::vector<std::string> const& args,
-        std::shared_ptr<arrow::Schema> const& schema)
+        std::shared_ptr<arrow::compute::FunctionOptions> const& options =
+            nullptr) const;
+
+    /// one internal::GroupBy pass of arrow's hash_<function> kernels over the
+    /// group ids, a column for every (functions[i], values[i])
+    arrow::Result<arrow::ArrayVector> hashKernels(
+        std::vector<std::string> const& functions,
+        arrow::ArrayVector const& values,
+        std::shared_ptr<arrow::compute::FunctionOptions> const& options =
+            nullptr) const;
+
+    /// the values of arg sorted by group and then by value, nulls last in
+    /// each group, and the groupSize() + 1 offsets where the groups start
+    arrow::Result<std::pair<std::shared_ptr<arrow::Array>, std::vector<int64_t>>>
+    sortedByGroup(std::string const& arg) const;
+
+    /// the first or last row of every group
+    std::shared_ptr<arrow::Array> boundaryRows(bool last) const;
+
+    arrow::Result<std::shared_ptr<arrow::Array>> modeOf(
+        std::string const& arg) const;
+
+    arrow::Result<std::shared_ptr<arrow::Array>> quantileOf(
+        std::string const& arg,
+        double q) const;
+
+    /// fn of every group id, in parallel batches of groups; the results in
+    /// group order
+    arrow::Result<std::shared_ptr<arrow::Array>> applyBatched(
+        std::function<std::shared_ptr<arrow::Scalar>(::int64_t)> const& fn)
+        const;
+
+    /// fn of the values of arg of every group, a zero-copy slice of them in
+    /// group order, run in parallel. fn returns one value per row of the
+    /// group; the results are put back in row order
+    arrow::Result<pd::Series> segmentWise(
+        std::string const& arg,
+        std::function<arrow::Result<std::shared_ptr<arrow::Array>>(
+            std::shared_ptr<arrow::Array> const&)> const& fn) const;
+
+    /// a frame of one row per group, indexed by the keys
+    pd::DataFrame makeFrame(
+        std::vector<std::string> const& names,
+        arrow::ArrayVector const& columns) const;
+};
+
+/// Rolling windows within the groups of a GroupBy, which must outlive it:
+///
+///     auto ma = df.group_by("sym").rolling(20).mean("px");
+///
+/// A window covers the current row and the window - 1 rows of its group
+/// before it; it is null with fewer than minPeriods non-null values. NaNs
+/// count as nulls. The result is double, aligned to the rows of the frame.
+struct GroupByRolling
+{
+    GroupBy const& groupBy;
+    int64_t window;
+    int64_t minPeriods;
+
+    arrow::Result<pd::Series> sum(std::string const& arg) const;
+    arrow::Result<pd::Series> mean(std::string const& arg) const;
+
+private:
+    arrow::Result<pd::Series> apply(std::string const& arg, bool mean) const;
+};
+
+/// Running aggregates by key of a stream of record batches, e.g. market data
+/// consumed batch by batch:
+///
+///     pd::StreamingGroupBy bars("sym", { { "px", { "last", "mean" } },
+///                                        { "qty", { "sum" } } });
+///     for (auto const& batch : batches) bars.consume(*batch);
+///     auto frame = bars.snapshot();
+///
+/// Every batch is grouped on its own like GroupBy, and only its distinct keys
+/// go through a persistent Grouper numbering the groups across batches by
+/// first appearance. Its per group partial states are merged into the
+/// running GroupAccumulator states, so a batch never touches the history.
+/// snapshot() answers at any time with the columns, names and index
+/// GroupBy::agg gives over all the rows consumed. sum, count, mean, min, max,
+/// last, var (variance) and std (stddev) of numeric columns are covered.
+class StreamingGroupBy
+{
+public:
+    StreamingGroupBy(
+        std::string key,
+        std::vector<std::pair<std::string, std::vector<std::string>>>
+            aggregations)
+        : StreamingGroupBy(
+              std::vector<std::string>{ std::move(key) },
+              std::move(aggregations))
     {
-        arrow::FieldVector fv(args.size());
-        std::ranges::transform(
-            args,
-            fv.begin(),
-            [&](auto const& arg) { return schema->GetFieldByName(arg); });
-        return fv;
     }
+
+    /// throws std::invalid_argument for a function that is not covered
+    StreamingGroupBy(
+        std::vector<std::string> keys,
+        std::vector<std::pair<std::string, std::vector<std::string>>>
+            aggregations);
+
+    /// the key and value columns keep the types of the first batch
+    arrow::Status consume(arrow::RecordBatch const& batch);
+
+    inline arrow::Status consume(pd::DataFrame const& df)
+    {
+        return consume(*df.m_array);
+    }
+
+    /// one row per group seen so far, an error before the first batch
+    arrow::Result<pd::DataFrame> snapshot() const;
+
+    inline int64_t groupSize() const
+    {
+        return m_grouper ? static_cast<int64_t>(m_grouper->num_groups()) : 0;
+    }
+
+private:
+    std::vector<std::string> m_keys;
+    std::vector<std::pair<std::string, std::vector<std::string>>> m_aggregations;
+    std::unique_ptr<arrow::compute::Grouper> m_grouper;
+    arrow::DataTypeVector m_keyTypes;
+    /// one per aggregation, made from the first batch
+    std::vector<GroupAccumulator> m_accumulators;
 };
 
 #define RESAMPLE_GROUP_BY_FUNCTION(name) \
@@ -243,8 +463,9 @@ private:
 
 struct Resampler : protected GroupBy
 {
+    // the bins of a resampled index are sorted by construction
     Resampler(DataFrame const& _df)
-        : GroupBy("__resampler_idx__", _df )
+        : GroupBy("__resampler_idx__", _df, true)
     {
     }
 
@@ -0,0 +1,1326 @@
+//
+// Created by dewe on 10/17/26.
+//
+#include "grouping.h"
+#include <arrow/array/concatenate.h>
+#include <arrow/compute/api_vector.h>
+#include <arrow/compute/exec.h>
+#include <arrow/compute/row/grouper.h>
+#include <arrow/type_traits.h>
+#include <arrow/util/bit_util.h>
+#include <arrow/util/hashing.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <atomic>
+#include <cstring>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include "core.h"
+#include "parallel.h"
+
+
+namespace pd {
+
+using namespace arrow::compute;
+
+static arrow::Result<std::shared_ptr<arrow::UInt32Array>> consume(
+    Grouper& grouper,
+    arrow::ArrayVector const& columns)
+{
+    std::vector<arrow::Datum> values(columns.begin(), columns.end());
+    ARROW_ASSIGN_OR_RAISE(auto batch, ExecBatch::Make(values));
+    ARROW_ASSIGN_OR_RAISE(auto ids, grouper.Consume(ExecSpan(batch)));
+    return ids.array_as<arrow::UInt32Array>();
+}
+
+static arrow::Result<arrow::ArrayVector> uniquesOf(Grouper& grouper)
+{
+    ARROW_ASSIGN_OR_RAISE(auto uniques, grouper.GetUniques());
+    arrow::ArrayVector columns;
+    for (auto const& values : uniques.values)
+    {
+        columns.push_back(values.make_array());
+    }
+    return columns;
+}
+
+static arrow::ArrayVector sliceAll(
+    arrow::ArrayVector const& columns,
+    int64_t offset,
+    int64_t length)
+{
+    arrow::ArrayVector slices;
+    for (auto const& column : columns)
+    {
+        slices.push_back(column->Slice(offset, length));
+    }
+    return slices;
+}
+
+/// whether hashRows covers keys of type
+static bool hashable(arrow::DataType const& type)
+{
+    if (arrow::is_base_binary_like(type.id()) or
+        type.id() == arrow::Type::BOOL)
+    {
+        return true;
+    }
+    auto fixedWidth = dynamic_cast<arrow::FixedWidthType const*>(&type);
+    return fixedWidth != nullptr and type.id() != arrow::Type::DICTIONARY and
+        fixedWidth->bit_width() % 8 == 0;
+}
+
+template<class Hash>
+static void combineHashes(
+    arrow::Array const& column,
+    std::vector<uint64_t>& hashes,
+    Hash&& hashOf)
+{
+    for (int64_t row = 0; row < column.length(); ++row)
+    {
+        uint64_t hash = column.IsNull(row) ? 0 : hashOf(row) + 1;
+        hashes[row] = hashes[row] * 0x9E3779B97F4A7C15ULL + hash;
+    }
+}
+
+/// a hash of every row of hashable columns, equal keys (nulls included) hash
+/// equally
+static std::vector<uint64_t> hashRows(arrow::ArrayVector const& columns)
+{
+    using arrow::internal::ComputeStringHash;
+
+    std::vector<uint64_t> hashes(columns.front()->length(), 0);
+    for (auto const& column : columns)
+    {
+        switch (column->type_id())
+        {
+            case arrow::Type::BOOL:
+            {
+                auto const& bools = static_cast<arrow::BooleanArray const&>(*column);
+                combineHashes(*column, hashes, [&](int64_t row)
+                              { return static_cast<uint64_t>(bools.Value(row)); });
+                break;
+            }
+            case arrow::Type::BINARY:
+            case arrow::Type::STRING:
+            {
+                auto const& binary = static_cast<arrow::BinaryArray const&>(*column);
+                combineHashes(*column, hashes, [&](int64_t row)
+                              {
+                                  auto view = binary.GetView(row);
+                                  return ComputeStringHash<0>(view.data(), view.size());
+                              });
+                break;
+            }
+            case arrow::Type::LARGE_BINARY:
+            case arrow::Type::LARGE_STRING:
+            {
+                auto const& binary =
+                    static_cast<arrow::LargeBinaryArray const&>(*column);
+                combineHashes(*column, hashes, [&](int64_t row)
+                              {
+                                  auto view = binary.GetView(row);
+                                  return ComputeStringHash<0>(view.data(), view.size());
+                              });
+                break;
+            }
+            default:
+            {
+                // any fixed width value, hashed by its bytes as the Grouper
+                // compares them
+                auto const& data = *column->data();
+                auto width = static_cast<arrow::FixedWidthType const&>(*data.type)
+                                 .bit_width() / 8;
+                auto values = data.buffers[1]->data() + data.offset * width;
+                combineHashes(*column, hashes, [&](int64_t row)
+                              { return ComputeStringHash<0>(values + row * width, width); });
+                break;
+            }
+        }
+    }
+    return hashes;
+}
+
+template<class T>
+static bool isMonotonic(T const* values, int64_t length)
+{
+    std::atomic<bool> ascending{ true }, descending{ true };
+    auto numMorsels = (length + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE;
+    tbb::parallel_for(
+        int64_t{ 0 },
+        numMorsels,
+        [&](int64_t morsel)
+        {
+            auto end = std::min(length, (morsel + 1) * PD_MORSEL_SIZE);
+            for (auto row = std::max<int64_t>(morsel * PD_MORSEL_SIZE, 1);
+                 row < end and (ascending or descending);
+                 ++row)
+            {
+                if (not(values[row - 1] <= values[row]))
+                {
+                    ascending = false;
+                }
+                if (not(values[row - 1] >= values[row]))
+                {
+                    descending = false;
+                }
+            }
+        });
+    return ascending or descending;
+}
+
+/// whether equal values of column only sit next to each other, checked for
+/// integer and temporal columns without nulls. Floating point keys are left
+/// to hashing: runs split by bytes, where -0.0 == 0.0 and NaNs order nothing
+static bool isMonotonic(arrow::Array const& column)
+{
+    if (column.null_count() != 0)
+    {
+        return false;
+    }
+
+    auto const& data = *column.data();
+    auto id = column.type_id();
+    auto length = column.length();
+    if (arrow::is_temporal(id))
+    {
+        auto width = static_cast<arrow::FixedWidthType const&>(*data.type).bit_width();
+        return width == 64 ? isMonotonic(data.GetValues<int64_t>(1), length)
+            : width == 32  ? isMonotonic(data.GetValues<int32_t>(1), length)
+                           : false;
+    }
+    switch (id)
+    {
+        case arrow::Type::INT8:
+            return isMonotonic(data.GetValues<int8_t>(1), length);
+        case arrow::Type::INT16:
+            return isMonotonic(data.GetValues<int16_t>(1), length);
+        case arrow::Type::INT32:
+            return isMonotonic(data.GetValues<int32_t>(1), length);
+        case arrow::Type::INT64:
+            return isMonotonic(data.GetValues<int64_t>(1), length);
+        case arrow::Type::UINT8:
+            return isMonotonic(data.GetValues<uint8_t>(1), length);
+        case arrow::Type::UINT16:
+            return isMonotonic(data.GetValues<uint16_t>(1), length);
+        case arrow::Type::UINT32:
+            return isMonotonic(data.GetValues<uint32_t>(1), length);
+        case arrow::Type::UINT64:
+            return isMonotonic(data.GetValues<uint64_t>(1), length);
+        default:
+            return false;
+    }
+}
+
+/// sets starts[row] for the rows of [begin, end) whose value differs from
+/// the row before, nulls being equal to each other only
+template<class Same>
+static void markChanges(
+    arrow::Array const& column,
+    int64_t begin,
+    int64_t end,
+    uint8_t* starts,
+    Same&& same)
+{
+    auto nullable = column.null_count() != 0;
+    for (auto row = std::max<int64_t>(begin, 1); row < end; ++row)
+    {
+        if (starts[row])
+        {
+            continue;
+        }
+        if (nullable)
+        {
+            auto null = column.IsNull(row);
+            if (null != column.IsNull(row - 1))
+            {
+                starts[row] = 1;
+                continue;
+            }
+            if (null)
+            {
+                continue;
+            }
+        }
+        if (not same(row - 1, row))
+        {
+            starts[row] = 1;
+        }
+    }
+}
+
+static void markChanges(
+    arrow::Array const& column,
+    int64_t begin,
+    int64_t end,
+    uint8_t* starts)
+{
+    switch (column.type_id())
+    {
+        case arrow::Type::BOOL:
+        {
+            auto const& bools = static_cast<arrow::BooleanArray const&>(column);
+            markChanges(column, begin, end, starts, [&](int64_t a, int64_t b)
+                        { return bools.Value(a) == bools.Value(b); });
+            return;
+        }
+        case arrow::Type::BINARY:
+        case arrow::Type::STRING:
+        {
+            auto const& binary = static_cast<arrow::BinaryArray const&>(column);
+            markChanges(column, begin, end, starts, [&](int64_t a, int64_t b)
+                        { return binary.GetView(a) == binary.GetView(b); });
+            return;
+        }
+        case arrow::Type::LARGE_BINARY:
+        case arrow::Type::LARGE_STRING:
+        {
+            auto const& binary = static_cast<arrow::LargeBinaryArray const&>(column);
+            markChanges(column, begin, end, starts, [&](int64_t a, int64_t b)
+                        { return binary.GetView(a) == binary.GetView(b); });
+            return;
+        }
+        default:
+            break;
+    }
+
+    if (hashable(*column.type()))
+    {
+        auto const& data = *column.data();
+        auto width = static_cast<arrow::FixedWidthType const&>(*data.type)
+                         .bit_width() / 8;
+        auto values = data.buffers[1]->data() + data.offset * width;
+        markChanges(column, begin, end, starts, [&](int64_t a, int64_t b)
+                    { return std::memcmp(values + a * width, values + b * width, width) == 0; });
+        return;
+    }
+    markChanges(column, begin, end, starts, [&](int64_t a, int64_t b)
+                { return column.RangeEquals(column, a, a + 1, b); });
+}
+
+/// one group per run of equal adjacent rows, no hashing
+static arrow::Result<RowGroups> groupRuns(arrow::ArrayVector const& keys)
+{
+    auto length = keys.front()->length();
+    auto numMorsels = (length + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE;
+
+    std::vector<uint8_t> starts(length, 0);
+    if (length > 0)
+    {
+        starts[0] = 1;
+    }
+    std::vector<int64_t> runsBefore(numMorsels + 1, 0);
+    tbb::parallel_for(
+        int64_t{ 0 },
+        numMorsels,
+        [&](int64_t morsel)
+        {
+            auto begin = morsel * PD_MORSEL_SIZE;
+            auto end = std::min(length, begin + PD_MORSEL_SIZE);
+            for (auto const& key : keys)
+            {
+                markChanges(*key, begin, end, starts.data());
+            }
+            runsBefore[morsel + 1] =
+                std::count(starts.begin() + begin, starts.begin() + end, 1);
+        });
+    std::partial_sum(runsBefore.begin(), runsBefore.end(), runsBefore.begin());
+
+    RowGroups groups;
+    groups.runs.resize(runsBefore.back() + 1);
+    groups.runs.back() = length;
+    ARROW_ASSIGN_OR_RAISE(
+        auto buffer,
+        arrow::AllocateBuffer(length * static_cast<int64_t>(sizeof(uint32_t))));
+    auto ids = reinterpret_cast<uint32_t*>(buffer->mutable_data());
+    tbb::parallel_for(
+        int64_t{ 0 },
+        numMorsels,
+        [&](int64_t morsel)
+        {
+            auto run = runsBefore[morsel] - 1;
+            auto end = std::min(length, (morsel + 1) * PD_MORSEL_SIZE);
+            for (auto row = morsel * PD_MORSEL_SIZE; row < end; ++row)
+            {
+                if (starts[row])
+                {
+                    groups.runs[++run] = row;
+                }
+                ids[row] = static_cast<uint32_t>(run);
+            }
+        });
+    groups.ids = std::make_shared<arrow::UInt32Array>(length, std::move(buffer));
+
+    std::vector<int64_t> firstRows(groups.runs.begin(), groups.runs.end() - 1);
+    auto first = arrow::ArrayT<int64_t>::Make(firstRows);
+    for (auto const& key : keys)
+    {
+        ARROW_ASSIGN_OR_RAISE(auto unique, Take(*key, *first));
+        groups.uniques.push_back(std::move(unique));
+    }
+    return groups;
+}
+
+arrow::Result<RowGroups> GroupRows(arrow::ArrayVector const& keys, bool sorted)
+{
+    if (sorted or (keys.size() == 1 and isMonotonic(*keys.front())))
+    {
+        return groupRuns(keys);
+    }
+
+    std::vector<arrow::TypeHolder> types;
+    for (auto const& key : keys)
+    {
+        types.emplace_back(key->type());
+    }
+
+    auto length = keys.front()->length();
+    auto numMorsels = (length + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE;
+    if (numMorsels <= 1)
+    {
+        ARROW_ASSIGN_OR_RAISE(auto grouper, Grouper::Make(types));
+        RowGroups groups;
+        ARROW_ASSIGN_OR_RAISE(groups.ids, consume(*grouper, keys));
+        ARROW_ASSIGN_OR_RAISE(groups.uniques, uniquesOf(*grouper));
+        return groups;
+    }
+
+    struct Morsel
+    {
+        /// the local id of every row
+        std::shared_ptr<arrow::UInt32Array> ids;
+        /// the distinct keys, by local id
+        arrow::ArrayVector uniques;
+        /// the merge partition of every local id, empty with one partition
+        std::vector<uint32_t> partition;
+        /// local ids ordered by partition, empty with one partition
+        std::vector<int64_t> order;
+        /// uniques in that order, partition p starting at starts[p]
+        arrow::ArrayVector byPartition;
+        std::vector<int64_t> starts;
+        /// the id of every local id within its partition, then globally
+        std::vector<uint32_t> merged;
+        std::vector<uint32_t> global;
+
+        int64_t numUniques() const
+        {
+            return uniques.front()->length();
+        }
+    };
+
+    std::vector<Morsel> morsels(numMorsels);
+    std::mutex errorMutex;
+    arrow::Status status;
+    auto forEach = [&](int64_t count, auto&& task)
+    {
+        tbb::parallel_for(
+            int64_t{ 0 },
+            count,
+            [&](int64_t i)
+            {
+                auto taskStatus = task(i);
+                if (not taskStatus.ok())
+                {
+                    std::lock_guard lock(errorMutex);
+                    status = std::move(taskStatus);
+                }
+            });
+        return status;
+    };
+
+    // every morsel on its own Grouper
+    ARROW_RETURN_NOT_OK(forEach(
+        numMorsels,
+        [&](int64_t m) -> arrow::Status
+        {
+            auto& morsel = morsels[m];
+            auto slices = sliceAll(keys, m * PD_MORSEL_SIZE, PD_MORSEL_SIZE);
+            ARROW_ASSIGN_OR_RAISE(auto grouper, Grouper::Make(types));
+            ARROW_ASSIGN_OR_RAISE(morsel.ids, consume(*grouper, slices));
+            ARROW_ASSIGN_OR_RAISE(morsel.uniques, uniquesOf(*grouper));
+            morsel.merged.resize(morsel.numUniques());
+            return arrow::Status::OK();
+        }));
+
+    // few distinct keys merge on one Grouper, many are split by hash so
+    // every partition merges its own on one task
+    int64_t numLocalUniques = 0;
+    for (auto const& morsel : morsels)
+    {
+        numLocalUniques += morsel.numUniques();
+    }
+    int64_t numPartitions = 1;
+    if (numLocalUniques > PD_MORSEL_SIZE and
+        std::all_of(keys.begin(), keys.end(),
+                    [](auto const& key) { return hashable(*key->type()); }))
+    {
+        numPartitions = std::min<int64_t>(
+            numLocalUniques / PD_MORSEL_SIZE,
+            tbb::this_task_arena::max_concurrency() * 4);
+    }
+
+    if (numPartitions == 1)
+    {
+        for (auto& morsel : morsels)
+        {
+            morsel.byPartition = morsel.uniques;
+            morsel.starts = { 0, morsel.numUniques() };
+        }
+    }
+    else
+    {
+        ARROW_RETURN_NOT_OK(forEach(
+            numMorsels,
+            [&](int64_t m) -> arrow::Status
+            {
+                auto& morsel = morsels[m];
+                auto n = morsel.numUniques();
+                auto hashes = hashRows(morsel.uniques);
+
+                // counting sort of the local ids by partition, stable
+                morsel.partition.resize(n);
+                morsel.starts.assign(numPartitions + 1, 0);
+                for (int64_t local = 0; local < n; ++local)
+                {
+                    morsel.partition[local] =
+                        static_cast<uint32_t>(hashes[local] % numPartitions);
+                    ++morsel.starts[morsel.partition[local] + 1];
+                }
+                std::partial_sum(
+                    morsel.starts.begin(), morsel.starts.end(), morsel.starts.begin());
+                auto cursors = morsel.starts;
+                morsel.order.resize(n);
+                for (int64_t local = 0; local < n; ++local)
+                {
+                    morsel.order[cursors[morsel.partition[local]]++] = local;
+                }
+
+                auto order = arrow::ArrayT<int64_t>::Make(morsel.order);
+                for (auto const& unique : morsel.uniques)
+                {
+                    ARROW_ASSIGN_OR_RAISE(auto taken, Take(*unique, *order));
+                    morsel.byPartition.push_back(std::move(taken));
+                }
+                return arrow::Status::OK();
+            }));
+    }
+
+    // every partition takes its keys from the morsels in order; the
+    // partitions write disjoint local ids of merged
+    std::vector<int64_t> partitionSizes(numPartitions);
+    ARROW_RETURN_NOT_OK(forEach(
+        numPartitions,
+        [&](int64_t p) -> arrow::Status
+        {
+            ARROW_ASSIGN_OR_RAISE(auto grouper, Grouper::Make(types));
+            for (auto& morsel : morsels)
+            {
+                auto begin = morsel.starts[p];
+                auto n = morsel.starts[p + 1] - begin;
+                if (n == 0)
+                {
+                    continue;
+                }
+                ARROW_ASSIGN_OR_RAISE(
+                    auto ids,
+                    consume(*grouper, sliceAll(morsel.byPartition, begin, n)));
+                for (int64_t i = 0; i < n; ++i)
+                {
+                    auto local = morsel.order.empty() ? begin + i
+                                                      : morsel.order[begin + i];
+                    morsel.merged[local] = ids->Value(i);
+                }
+            }
+            partitionSizes[p] = grouper->num_groups();
+            return arrow::Status::OK();
+        }));
+
+    // morsels in row order and local ids in first appearance order visit the
+    // groups in first appearance order, which numbers them
+    std::vector<std::vector<uint32_t>> globalIds(numPartitions);
+    for (int64_t p = 0; p < numPartitions; ++p)
+    {
+        globalIds[p].assign(partitionSizes[p], UINT32_MAX);
+    }
+    std::vector<int64_t> firstUniques;
+    int64_t uniqueOffset = 0;
+    for (auto& morsel : morsels)
+    {
+        auto n = morsel.numUniques();
+        morsel.global.resize(n);
+        for (int64_t local = 0; local < n; ++local)
+        {
+            auto p = morsel.partition.empty() ? 0 : morsel.partition[local];
+            auto& global = globalIds[p][morsel.merged[local]];
+            if (global == UINT32_MAX)
+            {
+                global = static_cast<uint32_t>(firstUniques.size());
+                firstUniques.push_back(uniqueOffset + local);
+            }
+            morsel.global[local] = global;
+        }
+        uniqueOffset += n;
+    }
+
+    ARROW_ASSIGN_OR_RAISE(
+        auto buffer,
+        arrow::AllocateBuffer(length * static_cast<int64_t>(sizeof(uint32_t))));
+    auto ids = reinterpret_cast<uint32_t*>(buffer->mutable_data());
+    tbb::parallel_for(
+        int64_t{ 0 },
+        numMorsels,
+        [&](int64_t m)
+        {
+            auto const& morsel = morsels[m];
+            auto local = morsel.ids->raw_values();
+            auto out = ids + m * PD_MORSEL_SIZE;
+            for (int64_t row = 0; row < morsel.ids->length(); ++row)
+            {
+                out[row] = morsel.global[local[row]];
+            }
+        });
+
+    RowGroups groups;
+    groups.ids = std::make_shared<arrow::UInt32Array>(length, std::move(buffer));
+    auto first = arrow::ArrayT<int64_t>::Make(firstUniques);
+    for (size_t column = 0; column < keys.size(); ++column)
+    {
+        arrow::ArrayVector pieces;
+        for (auto const& morsel : morsels)
+        {
+            pieces.push_back(morsel.uniques[column]);
+        }
+        ARROW_ASSIGN_OR_RAISE(auto all, arrow::Concatenate(pieces));
+        ARROW_ASSIGN_OR_RAISE(auto unique, Take(*all, *first));
+        groups.uniques.push_back(std::move(unique));
+    }
+    return groups;
+}
+
+namespace {
+
+template<class T>
+using SumOf = std::conditional_t<
+    std::is_floating_point_v<T>,
+    double,
+    std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+/// integer sums wrap around like arrow's unchecked sum
+template<class T>
+T addWrapping(T a, T b)
+{
+    if constexpr (std::is_integral_v<T>)
+    {
+        return static_cast<T>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    }
+    else
+    {
+        return a + b;
+    }
+}
+
+template<class T>
+struct SumReducer
+{
+    using Out = SumOf<T>;
+    struct State
+    {
+        Out sum{};
+        int64_t count{ 0 };
+    };
+
+    static void add(State& state, T value)
+    {
+        state.sum = addWrapping(state.sum, static_cast<Out>(value));
+        ++state.count;
+    }
+
+    static void merge(State& state, State const& other)
+    {
+        state.sum = addWrapping(state.sum, other.sum);
+        state.count += other.count;
+    }
+
+    static std::optional<Out> finish(State const& state)
+    {
+        return state.count > 0 ? std::optional<Out>{ state.sum } : std::nullopt;
+    }
+};
+
+template<class T>
+struct MeanReducer : SumReducer<T>
+{
+    using Out = double;
+    using State = typename SumReducer<T>::State;
+
+    static std::optional<Out> finish(State const& state)
+    {
+        if (state.count == 0)
+        {
+            return std::nullopt;
+        }
+        return static_cast<double>(state.sum) / static_cast<double>(state.count);
+    }
+};
+
+template<class T, bool Min>
+struct ExtremumReducer
+{
+    using Out = T;
+    struct State
+    {
+        T value{};
+        bool seen{ false };
+    };
+
+    static void add(State& state, T value)
+    {
+        if (not state.seen)
+        {
+            state.value = value;
+            state.seen = true;
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            // NaNs are skipped unless there is nothing else
+            state.value = Min ? std::fmin(state.value, value)
+                              : std::fmax(state.value, value);
+        }
+        else
+        {
+            state.value = Min ? std::min(state.value, value)
+                              : std::max(state.value, value);
+        }
+    }
+
+    static void merge(State& state, State const& other)
+    {
+        if (other.seen)
+        {
+            add(state, other.value);
+        }
+    }
+
+    static std::optional<Out> finish(State const& state)
+    {
+        return state.seen ? std::optional<Out>{ state.value } : std::nullopt;
+    }
+};
+
+template<class T>
+using MinReducer = ExtremumReducer<T, true>;
+template<class T>
+using MaxReducer = ExtremumReducer<T, false>;
+
+template<class T>
+struct CountReducer
+{
+    using Out = int64_t;
+    struct State
+    {
+        int64_t count{ 0 };
+    };
+
+    static void add(State& state, T)
+    {
+        ++state.count;
+    }
+
+    static void merge(State& state, State const& other)
+    {
+        state.count += other.count;
+    }
+
+    static std::optional<Out> finish(State const& state)
+    {
+        return state.count;
+    }
+};
+
+/// Welford's running mean and sum of squared deviations, merged with Chan's
+/// formula, population variance like the default ddof of 0
+template<class T>
+struct VarianceReducer
+{
+    using Out = double;
+    struct State
+    {
+        int64_t count{ 0 };
+        double mean{ 0 };
+        double m2{ 0 };
+    };
+
+    static void add(State& state, T value)
+    {
+        auto x = static_cast<double>(value);
+        ++state.count;
+        auto delta = x - state.mean;
+        state.mean += delta / static_cast<double>(state.count);
+        state.m2 += delta * (x - state.mean);
+    }
+
+    static void merge(State& state, State const& other)
+    {
+        if (other.count == 0)
+        {
+            return;
+        }
+        if (state.count == 0)
+        {
+            state = other;
+            return;
+        }
+        auto n = static_cast<double>(state.count + other.count);
+        auto delta = other.mean - state.mean;
+        state.mean += delta * static_cast<double>(other.count) / n;
+        state.m2 += other.m2 + delta * delta * static_cast<double>(state.count) *
+            static_cast<double>(other.count) / n;
+        state.count += other.count;
+    }
+
+    static std::optional<Out> finish(State const& state)
+    {
+        if (state.count == 0)
+        {
+            return std::nullopt;
+        }
+        return state.m2 / static_cast<double>(state.count);
+    }
+};
+
+template<class T>
+struct StddevReducer : VarianceReducer<T>
+{
+    using State = typename VarianceReducer<T>::State;
+
+    static std::optional<double> finish(State const& state)
+    {
+        auto variance = VarianceReducer<T>::finish(state);
+        return variance ? std::optional<double>{ std::sqrt(*variance) }
+                        : std::nullopt;
+    }
+};
+
+/// every statistic above from one pass over the values
+template<class T>
+struct FusedReducer
+{
+    struct State
+    {
+        typename SumReducer<T>::State sum;
+        typename MinReducer<T>::State min;
+        typename MaxReducer<T>::State max;
+        typename VarianceReducer<T>::State moments;
+    };
+
+    static void add(State& state, T value)
+    {
+        SumReducer<T>::add(state.sum, value);
+        MinReducer<T>::add(state.min, value);
+        MaxReducer<T>::add(state.max, value);
+        VarianceReducer<T>::add(state.moments, value);
+    }
+
+    static void merge(State& state, State const& other)
+    {
+        SumReducer<T>::merge(state.sum, other.sum);
+        MinReducer<T>::merge(state.min, other.min);
+        MaxReducer<T>::merge(state.max, other.max);
+        VarianceReducer<T>::merge(state.moments, other.moments);
+    }
+};
+
+}
+
+GroupReducer::GroupReducer(
+    std::shared_ptr<arrow::UInt32Array> ids,
+    int64_t numGroups,
+    std::vector<int64_t> runs)
+    : m_ids(std::move(ids)),
+      m_numGroups(numGroups),
+      m_runs(std::move(runs)),
+      m_partitions(std::make_unique<Partitions>())
+{
+}
+
+GroupReducer::Partitions const& GroupReducer::partitions() const
+{
+    auto& partitions = *m_partitions;
+    std::call_once(
+        partitions.built,
+        [&]
+        {
+            auto ids = m_ids->raw_values();
+            auto numPartitions = (m_numGroups + PD_GROUP_PARTITION_SIZE - 1) >>
+                PD_GROUP_PARTITION_BITS;
+            partitions.rows = scatterByPartition<uint32_t>(
+                m_ids->length(),
+                numPartitions,
+                [ids](int64_t row)
+                { return int64_t{ ids[row] >> PD_GROUP_PARTITION_BITS }; },
+                partitions.offsets);
+        });
+    return partitions;
+}
+
+std::vector<int64_t> GroupReducer::lastRows() const
+{
+    std::vector<int64_t> rows(m_numGroups, -1);
+    if (not m_runs.empty())
+    {
+        for (int64_t group = 0; group < m_numGroups; ++group)
+        {
+            rows[group] = m_runs[group + 1] - 1;
+        }
+        return rows;
+    }
+
+    auto ids = m_ids->raw_values();
+    for (int64_t row = 0; row < m_ids->length(); ++row)
+    {
+        rows[ids[row]] = row;
+    }
+    return rows;
+}
+
+template<class Reducer, class T>
+std::vector<typename Reducer::State> GroupReducer::fold(
+    arrow::ArrayData const& values) const
+{
+    using State = typename Reducer::State;
+
+    auto data = values.GetValues<T>(1);
+    auto validity = values.GetNullCount() > 0 ? values.buffers[0]->data() : nullptr;
+    auto offset = values.offset;
+    auto ids = m_ids->raw_values();
+    auto foldRow = [&](State* states, int64_t row)
+    {
+        if (validity == nullptr or arrow::bit_util::GetBit(validity, offset + row))
+        {
+            Reducer::add(states[ids[row]], data[row]);
+        }
+    };
+
+    std::vector<State> states(m_numGroups);
+    if (not m_runs.empty())
+    {
+        // every group folds its own slice of rows, nothing to merge
+        tbb::parallel_for(
+            tbb::blocked_range<int64_t>(0, m_numGroups),
+            [&](tbb::blocked_range<int64_t> const& groups)
+            {
+                for (auto group = groups.begin(); group < groups.end(); ++group)
+                {
+                    for (auto row = m_runs[group]; row < m_runs[group + 1]; ++row)
+                    {
+                        foldRow(states.data(), row);
+                    }
+                }
+            });
+    }
+    else if (m_numGroups <= PD_GROUP_PARTITION_SIZE)
+    {
+        tbb::enumerable_thread_specific<std::vector<State>> partials(
+            [&] { return std::vector<State>(m_numGroups); });
+        auto numMorsels = (values.length + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE;
+        tbb::parallel_for(
+            int64_t{ 0 },
+            numMorsels,
+            [&](int64_t morsel)
+            {
+                auto local = partials.local().data();
+                auto end = std::min(values.length, (morsel + 1) * PD_MORSEL_SIZE);
+                for (auto row = morsel * PD_MORSEL_SIZE; row < end; ++row)
+                {
+                    foldRow(local, row);
+                }
+            });
+        for (auto const& partial : partials)
+        {
+            for (int64_t group = 0; group < m_numGroups; ++group)
+            {
+                Reducer::merge(states[group], partial[group]);
+            }
+        }
+    }
+    else
+    {
+        auto const& partitions = this->partitions();
+        auto rows = partitions.rows.get();
+        tbb::parallel_for(
+            size_t{ 0 },
+            partitions.offsets.size() - 1,
+            [&](size_t p)
+            {
+                for (auto k = partitions.offsets[p]; k < partitions.offsets[p + 1];
+                     ++k)
+                {
+                    foldRow(states.data(), rows[k]);
+                }
+            });
+    }
+
+    return states;
+}
+
+/// one value per group of states, null where finish has none
+template<class Out, class State, class Finish>
+static std::shared_ptr<arrow::Array> finishStates(
+    std::vector<State> const& states,
+    Finish&& finish)
+{
+    std::vector<Out> result(states.size());
+    std::vector<bool> valid(states.size());
+    for (size_t group = 0; group < states.size(); ++group)
+    {
+        auto value = finish(states[group]);
+        valid[group] = value.has_value();
+        result[group] = value.value_or(Out{});
+    }
+    return arrow::ArrayT<Out>::Make(result, valid);
+}
+
+/// function of the fused states, nullptr when it is not fused
+template<class T>
+static std::shared_ptr<arrow::Array> finishFused(
+    std::vector<typename FusedReducer<T>::State> const& states,
+    std::string const& function)
+{
+    using State = typename FusedReducer<T>::State;
+    if (function == "sum")
+    {
+        return finishStates<typename SumReducer<T>::Out>(
+            states,
+            [](State const& state) { return SumReducer<T>::finish(state.sum); });
+    }
+    if (function == "mean")
+    {
+        return finishStates<double>(
+            states,
+            [](State const& state) { return MeanReducer<T>::finish(state.sum); });
+    }
+    if (function == "count")
+    {
+        return finishStates<int64_t>(
+            states,
+            [](State const& state)
+            { return std::optional<int64_t>{ state.sum.count }; });
+    }
+    if (function == "min")
+    {
+        return finishStates<T>(
+            states,
+            [](State const& state) { return MinReducer<T>::finish(state.min); });
+    }
+    if (function == "max")
+    {
+        return finishStates<T>(
+            states,
+            [](State const& state) { return MaxReducer<T>::finish(state.max); });
+    }
+    if (function == "variance")
+    {
+        return finishStates<double>(
+            states,
+            [](State const& state)
+            { return VarianceReducer<T>::finish(state.moments); });
+    }
+    if (function == "stddev")
+    {
+        return finishStates<double>(
+            states,
+            [](State const& state)
+            { return StddevReducer<T>::finish(state.moments); });
+    }
+    return nullptr;
+}
+
+template<class Reducer, class T>
+std::shared_ptr<arrow::Array> GroupReducer::run(arrow::ArrayData const& values) const
+{
+    return finishStates<typename Reducer::Out>(
+        fold<Reducer, T>(values),
+        Reducer::finish);
+}
+
+/// f(T{}) for the C type T of a numeric arrow type, R{} for any other type
+template<class R, class F>
+static R visitNumeric(arrow::Type::type id, F&& f)
+{
+    switch (id)
+    {
+        case arrow::Type::INT8:
+            return f(int8_t{});
+        case arrow::Type::INT16:
+            return f(int16_t{});
+        case arrow::Type::INT32:
+            return f(int32_t{});
+        case arrow::Type::INT64:
+            return f(int64_t{});
+        case arrow::Type::UINT8:
+            return f(uint8_t{});
+        case arrow::Type::UINT16:
+            return f(uint16_t{});
+        case arrow::Type::UINT32:
+            return f(uint32_t{});
+        case arrow::Type::UINT64:
+            return f(uint64_t{});
+        case arrow::Type::FLOAT:
+            return f(float{});
+        case arrow::Type::DOUBLE:
+            return f(double{});
+        default:
+            return R{};
+    }
+}
+
+template<template<class> class Reducer>
+std::shared_ptr<arrow::Array> GroupReducer::dispatch(
+    arrow::ArrayData const& values) const
+{
+    return visitNumeric<std::shared_ptr<arrow::Array>>(
+        values.type->id(),
+        [&]<class T>(T) { return run<Reducer<T>, T>(values); });
+}
+
+arrow::Result<std::shared_ptr<arrow::Array>> GroupReducer::reduce(
+    std::string const& function,
+    arrow::Array const& values) const
+{
+    if (not covers(values))
+    {
+        return nullptr;
+    }
+
+    auto const& data = *values.data();
+    if (function == "sum")
+    {
+        return dispatch<SumReducer>(data);
+    }
+    if (function == "mean")
+    {
+        return dispatch<MeanReducer>(data);
+    }
+    if (function == "min")
+    {
+        return dispatch<MinReducer>(data);
+    }
+    if (function == "max")
+    {
+        return dispatch<MaxReducer>(data);
+    }
+    if (function == "count")
+    {
+        return dispatch<CountReducer>(data);
+    }
+    if (function == "variance")
+    {
+        return dispatch<VarianceReducer>(data);
+    }
+    if (function == "stddev")
+    {
+        return dispatch<StddevReducer>(data);
+    }
+    if (function == "min_max")
+    {
+        auto min = dispatch<MinReducer>(data);
+        if (min == nullptr)
+        {
+            return nullptr;
+        }
+        ARROW_ASSIGN_OR_RAISE(
+            auto minMax,
+            arrow::StructArray::Make(
+                arrow::ArrayVector{ min, dispatch<MaxReducer>(data) },
+                std::vector<std::string>{ "min", "max" }));
+        return minMax;
+    }
+    return nullptr;
+}
+
+
+bool GroupReducer::covers(arrow::Array const& values) const
+{
+    return values.length() == m_ids->length() and
+        values.length() <= std::numeric_limits<uint32_t>::max();
+}
+
+arrow::Result<arrow::ArrayVector> GroupReducer::reduce(
+    std::vector<std::string> const& functions,
+    arrow::Array const& values) const
+{
+    static std::set<std::string> const fusable{
+        "sum", "mean", "min", "max", "count", "variance", "stddev"
+    };
+    arrow::ArrayVector columns(functions.size());
+    auto numFused = std::count_if(
+        functions.begin(),
+        functions.end(),
+        [](auto const& function) { return fusable.contains(function); });
+    if (numFused < 2 or not covers(values))
+    {
+        for (size_t i = 0; i < functions.size(); ++i)
+        {
+            ARROW_ASSIGN_OR_RAISE(columns[i], reduce(functions[i], values));
+        }
+        return columns;
+    }
+
+    auto const& data = *values.data();
+    auto fused = visitNumeric<arrow::ArrayVector>(
+        data.type->id(),
+        [&]<class T>(T)
+        {
+            auto states = fold<FusedReducer<T>, T>(data);
+            arrow::ArrayVector result(functions.size());
+            for (size_t i = 0; i < functions.size(); ++i)
+            {
+                result[i] = finishFused<T>(states, functions[i]);
+            }
+            return result;
+        });
+    if (not fused.empty())
+    {
+        columns = std::move(fused);
+    }
+    return columns;
+}
+
+/// the running states of a GroupAccumulator, typed by its column
+struct GroupAccumulatorStates
+{
+    virtual ~GroupAccumulatorStates() = default;
+};
+
+namespace {
+
+/// the value of the last row of a group
+template<class T>
+struct LastState
+{
+    T value{};
+    bool valid{ false };
+};
+
+template<class T>
+struct TypedGroupStates final : GroupAccumulatorStates
+{
+    std::vector<typename FusedReducer<T>::State> fused;
+    std::vector<LastState<T>> last;
+};
+
+}
+
+GroupAccumulator::GroupAccumulator(std::shared_ptr<arrow::DataType> type)
+    : m_type(std::move(type)),
+      m_states(visitNumeric<std::unique_ptr<GroupAccumulatorStates>>(
+          m_type->id(),
+          []<class T>(T) -> std::unique_ptr<GroupAccumulatorStates>
+          { return std::make_unique<TypedGroupStates<T>>(); }))
+{
+    if (m_states == nullptr)
+    {
+        throw std::invalid_argument(
+            m_type->ToString() + " values cannot be accumulated");
+    }
+}
+
+GroupAccumulator::GroupAccumulator(GroupAccumulator&&) noexcept = default;
+GroupAccumulator& GroupAccumulator::operator=(GroupAccumulator&&) noexcept = default;
+GroupAccumulator::~GroupAccumulator() = default;
+
+bool GroupAccumulator::covers(arrow::DataType const& type)
+{
+    return visitNumeric<bool>(type.id(), [](auto) { return true; });
+}
+
+arrow::Status GroupAccumulator::consume(
+    GroupReducer const& batch,
+    arrow::UInt32Array const& running,
+    int64_t numGroups,
+    arrow::Array const& values)
+{
+    if (not values.type()->Equals(*m_type))
+    {
+        return arrow::Status::TypeError(
+            "expected ",
+            m_type->ToString(),
+            " values, got ",
+            values.type()->ToString());
+    }
+    if (not batch.covers(values) or running.length() != batch.m_numGroups)
+    {
+        return arrow::Status::Invalid(
+            "values and running ids do not match the groups of the batch");
+    }
+
+    auto const& data = *values.data();
+    visitNumeric<bool>(
+        m_type->id(),
+        [&]<class T>(T)
+        {
+            auto& states = static_cast<TypedGroupStates<T>&>(*m_states);
+            states.fused.resize(numGroups);
+            states.last.resize(numGroups);
+
+            auto partial = batch.fold<FusedReducer<T>, T>(data);
+            auto rows = batch.lastRows();
+            auto ids = running.raw_values();
+            auto raw = data.GetValues<T>(1);
+            // the groups of a batch have distinct running ids, nothing is
+            // merged into the same state twice
+            tbb::parallel_for(
+                tbb::blocked_range<int64_t>(0, batch.m_numGroups),
+                [&](tbb::blocked_range<int64_t> const& groups)
+                {
+                    for (auto group = groups.begin(); group < groups.end(); ++group)
+                    {
+                        auto id = ids[group];
+                        FusedReducer<T>::merge(states.fused[id], partial[group]);
+                        auto row = rows[group];
+                        states.last[id] = LastState<T>{ raw[row], values.IsValid(row) };
+                    }
+                });
+            return true;
+        });
+    return arrow::Status::OK();
+}
+
+arrow::Result<std::shared_ptr<arrow::Array>> GroupAccumulator::finish(
+    std::string const& function) const
+{
+    auto result = visitNumeric<std::shared_ptr<arrow::Array>>(
+        m_type->id(),
+        [&]<class T>(T) -> std::shared_ptr<arrow::Array>
+        {
+            auto const& states =
+                static_cast<TypedGroupStates<T> const&>(*m_states);
+            if (function == "last")
+            {
+                return finishStates<T>(
+                    states.last,
+                    [](LastState<T> const& state)
+                    {
+                        return state.valid ? std::optional<T>{ state.value }
+                                           : std::nullopt;
+                    });
+            }
+            return finishFused<T>(states.fused, function);
+        });
+    if (result == nullptr)
+    {
+        return arrow::Status::NotImplemented(
+            function,
+            " is not accumulated over batches");
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,153 @@
+#pragma once
+//
+// Created by dewe on 10/17/26.
+//
+#include <arrow/api.h>
+#include <memory>
+#include <mutex>
+
+
+namespace pd {
+
+/// group ids per radix partition of GroupReducer, and the largest group count
+/// reduced through thread local partial states instead
+constexpr int64_t PD_GROUP_PARTITION_BITS = { 16 };
+constexpr int64_t PD_GROUP_PARTITION_SIZE = { 1 << PD_GROUP_PARTITION_BITS };
+
+/// The dense group of every row, numbered by first appearance, and the
+/// distinct keys in that order, one array per key column.
+struct RowGroups
+{
+    std::shared_ptr<arrow::UInt32Array> ids;
+    arrow::ArrayVector uniques;
+    /// the numGroups + 1 offsets of the groups when every group is one
+    /// contiguous run of rows, else empty
+    std::vector<int64_t> runs;
+};
+
+/// Groups the rows of the equal length key columns, with the same ids a
+/// single arrow Grouper would assign. Morsels of PD_MORSEL_SIZE rows are
+/// grouped in parallel by thread local Groupers; their distinct keys are then
+/// radix partitioned by hash and merged partition by partition in parallel,
+/// and every local id is remapped to its global id.
+///
+/// Keys that are sorted, or just keep equal rows next to each other, need no
+/// hashing: a group is a run of equal adjacent rows. sorted asserts that,
+/// and a single non-decreasing or non-increasing integer or temporal key
+/// without nulls is detected. Unsorted keys passed as sorted get one group
+/// per run.
+arrow::Result<RowGroups> GroupRows(
+    arrow::ArrayVector const& keys,
+    bool sorted = false);
+
+/// Parallel per group sum, mean, min, max, count, variance and stddev of
+/// numeric columns over the dense ids of GroupRows, with the output types
+/// and null rules of arrow's hash_* kernels (default options).
+///
+/// Up to PD_GROUP_PARTITION_SIZE groups, every thread folds its morsels into
+/// its own partial states, merged at the end. Above that, the rows are radix
+/// partitioned once by group id, so each partition owns a disjoint range of
+/// states and is reduced by one task with no merge. Groups that are runs of
+/// rows are folded straight from their slice of the values instead.
+class GroupReducer
+{
+    friend class GroupAccumulator;
+
+public:
+    /// runs as in RowGroups
+    GroupReducer(
+        std::shared_ptr<arrow::UInt32Array> ids,
+        int64_t numGroups,
+        std::vector<int64_t> runs = {});
+
+    /// one value per group, nullptr when function or the type of values is
+    /// not covered and the caller should use arrow's kernels
+    arrow::Result<std::shared_ptr<arrow::Array>> reduce(
+        std::string const& function,
+        arrow::Array const& values) const;
+
+    /// reduce for several functions over the same values: the ones covered
+    /// share a single pass over the ids, validity and values, the others are
+    /// nullptr
+    arrow::Result<arrow::ArrayVector> reduce(
+        std::vector<std::string> const& functions,
+        arrow::Array const& values) const;
+
+private:
+    struct Partitions
+    {
+        std::once_flag built;
+        /// numPartitions + 1 offsets into rows
+        std::vector<int64_t> offsets;
+        /// row positions, ascending within every partition
+        std::unique_ptr<uint32_t[]> rows;
+    };
+
+    std::shared_ptr<arrow::UInt32Array> m_ids;
+    int64_t m_numGroups;
+    std::vector<int64_t> m_runs;
+    std::unique_ptr<Partitions> m_partitions;
+
+    Partitions const& partitions() const;
+
+    /// the last row of every group
+    std::vector<int64_t> lastRows() const;
+
+    bool covers(arrow::Array const& values) const;
+
+    /// the Reducer state of every group after every valid row
+    template<class Reducer, class T>
+    std::vector<typename Reducer::State> fold(
+        arrow::ArrayData const& values) const;
+
+    template<class Reducer, class T>
+    std::shared_ptr<arrow::Array> run(arrow::ArrayData const& values) const;
+
+    template<template<class> class Reducer>
+    std::shared_ptr<arrow::Array> dispatch(arrow::ArrayData const& values) const;
+};
+
+struct GroupAccumulatorStates;
+
+/// The running per group states of one numeric column fed batch by batch:
+/// the sum, count, min, max and moments GroupReducer fuses, and the value of
+/// the last row. A batch is folded by its own GroupReducer and only its
+/// partial states are merged into the running ones, so it costs its rows and
+/// groups, not the rows consumed before it.
+class GroupAccumulator
+{
+public:
+    /// type must be covered
+    explicit GroupAccumulator(std::shared_ptr<arrow::DataType> type);
+    GroupAccumulator(GroupAccumulator&&) noexcept;
+    GroupAccumulator& operator=(GroupAccumulator&&) noexcept;
+    ~GroupAccumulator();
+
+    static bool covers(arrow::DataType const& type);
+
+    inline std::shared_ptr<arrow::DataType> const& type() const
+    {
+        return m_type;
+    }
+
+    /// folds values into the running groups: batch groups its rows, and
+    /// running holds the running id of every group of batch, new ones
+    /// included, out of numGroups
+    arrow::Status consume(
+        GroupReducer const& batch,
+        arrow::UInt32Array const& running,
+        int64_t numGroups,
+        arrow::Array const& values);
+
+    /// one value per running group: sum, mean, min, max, count, variance and
+    /// stddev as GroupReducer::reduce over every row consumed, and last, the
+    /// value of the last row, null when it is null
+    arrow::Result<std::shared_ptr<arrow::Array>> finish(
+        std::string const& function) const;
+
+private:
+    std::shared_ptr<arrow::DataType> m_type;
+    std::unique_ptr<GroupAccumulatorStates> m_states;
+};
+
+}
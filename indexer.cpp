@@ -0,0 +1,512 @@
+//
+// Created by dewe on 10/17/26.
+//
+#include "indexer.h"
+#include <algorithm>
+#include <arrow/compute/cast.h>
+#include <arrow/util/bit_util.h>
+#include <arrow/visit_type_inline.h>
+#include <bit>
+#include <iterator>
+#include <string_view>
+#include <tbb/parallel_for.h>
+#include "core.h"
+#include "parallel.h"
+
+
+namespace pd {
+
+// arrays at least this long are hashed and probed in parallel
+constexpr int64_t PD_PARALLEL_INDEXER_THRESHOLD = { 1 << 17 };
+// a parallel build splits the table into 2^bits independently built parts
+constexpr int PD_INDEXER_PARTITION_BITS = { 4 };
+
+static inline uint64_t mixHash(uint64_t x)
+{
+    // splitmix64 finalizer, spreads sequential ids and timestamps
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+template<class KeyT>
+static inline uint64_t hashKey(KeyT key)
+{
+    if constexpr (std::same_as<KeyT, std::string_view>)
+    {
+        return mixHash(std::hash<std::string_view>{}(key));
+    }
+    else if constexpr (std::same_as<KeyT, double>)
+    {
+        // -0.0 == 0.0, so they have to hash the same
+        return mixHash(std::bit_cast<uint64_t>(key == 0 ? 0.0 : key));
+    }
+    else if constexpr (std::same_as<KeyT, float>)
+    {
+        return mixHash(std::bit_cast<uint32_t>(key == 0 ? 0.0f : key));
+    }
+    else
+    {
+        return mixHash(static_cast<uint64_t>(key));
+    }
+}
+
+template<class ArrowType>
+struct IndexKey
+{
+    using type = typename ArrowType::c_type;
+};
+
+template<class ArrowType>
+    requires arrow::is_base_binary_type<ArrowType>::value
+struct IndexKey<ArrowType>
+{
+    using type = std::string_view;
+};
+
+/// the physical type an index of type is hashed as, nullptr when there is
+/// no flat indexer for it
+static std::shared_ptr<arrow::DataType> storageType(
+    std::shared_ptr<arrow::DataType> const& type)
+{
+    switch (type->id())
+    {
+        case arrow::Type::INT8:
+        case arrow::Type::INT16:
+        case arrow::Type::INT32:
+        case arrow::Type::INT64:
+        case arrow::Type::UINT8:
+        case arrow::Type::UINT16:
+        case arrow::Type::UINT32:
+        case arrow::Type::UINT64:
+        case arrow::Type::FLOAT:
+        case arrow::Type::DOUBLE:
+        case arrow::Type::STRING:
+        case arrow::Type::BINARY:
+        case arrow::Type::LARGE_STRING:
+        case arrow::Type::LARGE_BINARY:
+            return type;
+        case arrow::Type::DATE32:
+        case arrow::Type::TIME32:
+            return arrow::int32();
+        case arrow::Type::DATE64:
+        case arrow::Type::TIME64:
+        case arrow::Type::TIMESTAMP:
+        case arrow::Type::DURATION:
+            return arrow::int64();
+        default:
+            return nullptr;
+    }
+}
+
+/// array reinterpreted as storage, sharing its buffers
+static std::shared_ptr<arrow::Array> viewAs(
+    std::shared_ptr<arrow::Array> const& array,
+    std::shared_ptr<arrow::DataType> const& storage)
+{
+    if (array->type()->Equals(storage))
+    {
+        return array;
+    }
+    auto data = array->data()->Copy();
+    data->type = storage;
+    return arrow::MakeArray(data);
+}
+
+template<class ArrowType>
+class FlatIndexer final : public IndexerImpl
+{
+    using ArrayType = typename arrow::TypeTraits<ArrowType>::ArrayType;
+    using KeyT = typename IndexKey<ArrowType>::type;
+
+    struct Table
+    {
+        std::vector<int64_t> slots;
+        uint64_t mask{ 0 };
+        size_t size{ 0 };
+    };
+
+public:
+    FlatIndexer(
+        std::shared_ptr<arrow::Array> const& index,
+        std::shared_ptr<arrow::Array> const& storage)
+        : m_index(index),
+          m_storage(std::static_pointer_cast<ArrayType>(storage))
+    {
+        int64_t n = m_storage->length();
+        bool parallel = n >= PD_PARALLEL_INDEXER_THRESHOLD;
+        m_partitionBits = parallel ? PD_INDEXER_PARTITION_BITS : 0;
+        m_tables.resize(size_t{ 1 } << m_partitionBits);
+
+        auto reserve = [](Table& table, size_t rows)
+        {
+            auto capacity = std::bit_ceil(std::max<size_t>(rows * 2, 8));
+            table.slots.assign(capacity, -1);
+            table.mask = capacity - 1;
+        };
+
+        // rows are inserted in row order, so the last occurrence of a label
+        // wins as in a serial build
+        if (not parallel)
+        {
+            auto& table = m_tables.front();
+            reserve(table, size_t(n - m_storage->null_count()));
+            for (int64_t i = 0; i < n; i++)
+            {
+                if (m_storage->IsValid(i))
+                {
+                    insert(table, i, hashKey(keyOf(*m_storage, i)));
+                }
+            }
+        }
+        else
+        {
+            // hash the rows, scatter them once to their partition, then
+            // build every table from its own slice of rows
+            auto numPartitions = int64_t(m_tables.size());
+            auto numMorsels = (n + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE;
+            std::vector<uint64_t> hashes(n);
+            tbb::parallel_for(
+                int64_t{ 0 },
+                numMorsels,
+                [&](int64_t morsel)
+                {
+                    auto end = std::min(n, (morsel + 1) * PD_MORSEL_SIZE);
+                    for (auto i = morsel * PD_MORSEL_SIZE; i < end; i++)
+                    {
+                        if (m_storage->IsValid(i))
+                        {
+                            hashes[i] = hashKey(keyOf(*m_storage, i));
+                        }
+                    }
+                });
+
+            std::vector<int64_t> offsets;
+            auto rows = scatterByPartition<int64_t>(
+                n,
+                numPartitions,
+                [&](int64_t i)
+                {
+                    return m_storage->IsValid(i) ?
+                        static_cast<int64_t>(partition(hashes[i])) :
+                        int64_t{ -1 };
+                },
+                offsets);
+
+            tbb::parallel_for(
+                int64_t{ 0 },
+                numPartitions,
+                [&](int64_t p)
+                {
+                    auto& table = m_tables[p];
+                    reserve(table, size_t(offsets[p + 1] - offsets[p]));
+                    for (auto k = offsets[p]; k < offsets[p + 1]; k++)
+                    {
+                        insert(table, rows[k], hashes[rows[k]]);
+                    }
+                });
+        }
+
+        for (auto const& table : m_tables)
+        {
+            m_size += table.size;
+        }
+    }
+
+    size_t size() const override
+    {
+        return m_size;
+    }
+
+    int64_t find(arrow::Scalar const& label) const override
+    {
+        if (not label.is_valid)
+        {
+            return -1;
+        }
+        auto array = arrow::MakeArrayFromScalar(label, 1);
+        return array.ok() ? find(**array)[0] : -1;
+    }
+
+    std::vector<int64_t> find(arrow::Array const& labels) const override
+    {
+        std::vector<int64_t> result(labels.length(), -1);
+
+        std::shared_ptr<arrow::Array> converted = arrow::MakeArray(labels.data());
+        if (not labels.type()->Equals(m_index->type()))
+        {
+            auto cast = arrow::compute::Cast(*converted, m_index->type());
+            if (not cast.ok())
+            {
+                // some labels do not fit the index type, look them up one by one
+                for (int64_t i = 0; i < labels.length(); i++)
+                {
+                    auto label = labels.GetScalar(i);
+                    auto labelCast = label.ok() ?
+                        (*label)->CastTo(m_index->type()) :
+                        arrow::Result<std::shared_ptr<arrow::Scalar>>{ label.status() };
+                    if (labelCast.ok())
+                    {
+                        result[i] = find(**labelCast);
+                    }
+                }
+                return result;
+            }
+            converted = *cast;
+        }
+
+        auto typed = std::static_pointer_cast<ArrayType>(
+            viewAs(converted, m_storage->type()));
+        auto lookupRange = [&](int64_t begin, int64_t end)
+        {
+            for (int64_t i = begin; i < end; i++)
+            {
+                if (typed->IsValid(i))
+                {
+                    result[i] = lookup(keyOf(*typed, i));
+                }
+            }
+        };
+
+        if (labels.length() >= PD_PARALLEL_INDEXER_THRESHOLD)
+        {
+            tbb::parallel_for(
+                tbb::blocked_range<int64_t>(0, labels.length()),
+                [&](tbb::blocked_range<int64_t> const& r)
+                { lookupRange(r.begin(), r.end()); });
+        }
+        else
+        {
+            lookupRange(0, labels.length());
+        }
+        return result;
+    }
+
+    std::vector<int64_t> positions() const override
+    {
+        std::vector<int64_t> result;
+        result.reserve(m_size);
+        for (auto const& table : m_tables)
+        {
+            std::ranges::copy_if(
+                table.slots,
+                std::back_inserter(result),
+                [](int64_t slot) { return slot != -1; });
+        }
+        std::ranges::sort(result);
+        return result;
+    }
+
+private:
+    std::shared_ptr<arrow::Array> m_index;
+    std::shared_ptr<ArrayType> m_storage;
+    std::vector<Table> m_tables;
+    int m_partitionBits{ 0 };
+    size_t m_size{ 0 };
+
+    static inline KeyT keyOf(ArrayType const& array, int64_t i)
+    {
+        if constexpr (std::same_as<KeyT, std::string_view>)
+        {
+            return array.GetView(i);
+        }
+        else
+        {
+            return array.Value(i);
+        }
+    }
+
+    inline size_t partition(uint64_t hash) const
+    {
+        return m_partitionBits == 0 ? 0 : hash >> (64 - m_partitionBits);
+    }
+
+    void insert(Table& table, int64_t row, uint64_t hash)
+    {
+        auto key = keyOf(*m_storage, row);
+        for (auto i = hash & table.mask;; i = (i + 1) & table.mask)
+        {
+            auto& slot = table.slots[i];
+            if (slot == -1)
+            {
+                slot = row;
+                table.size++;
+                return;
+            }
+            if (keyOf(*m_storage, slot) == key)
+            {
+                slot = row;
+                return;
+            }
+        }
+    }
+
+    int64_t lookup(KeyT key) const
+    {
+        auto hash = hashKey(key);
+        auto const& table = m_tables[partition(hash)];
+        for (auto i = hash & table.mask;; i = (i + 1) & table.mask)
+        {
+            auto slot = table.slots[i];
+            if (slot == -1 or keyOf(*m_storage, slot) == key)
+            {
+                return slot;
+            }
+        }
+    }
+};
+
+/// boxed scalar fallback for index types without a flat indexer
+class ScalarIndexer final : public IndexerImpl
+{
+public:
+    explicit ScalarIndexer(std::shared_ptr<arrow::Array> const& index)
+        : m_type(index->type())
+    {
+        for (int64_t i = 0; i < index->length(); i++)
+        {
+            if (index->IsValid(i))
+            {
+                m_map[index->GetScalar(i).MoveValueUnsafe()] = i;
+            }
+        }
+    }
+
+    size_t size() const override
+    {
+        return m_map.size();
+    }
+
+    int64_t find(arrow::Scalar const& label) const override
+    {
+        if (not label.is_valid)
+        {
+            return -1;
+        }
+        auto key = label.CastTo(m_type);
+        if (not key.ok())
+        {
+            return -1;
+        }
+        auto it = m_map.find(*key);
+        return it == m_map.end() ? -1 : it->second;
+    }
+
+    std::vector<int64_t> find(arrow::Array const& labels) const override
+    {
+        std::vector<int64_t> result(labels.length(), -1);
+        for (int64_t i = 0; i < labels.length(); i++)
+        {
+            if (auto label = labels.GetScalar(i); label.ok())
+            {
+                result[i] = find(**label);
+            }
+        }
+        return result;
+    }
+
+    std::vector<int64_t> positions() const override
+    {
+        std::vector<int64_t> result;
+        result.reserve(m_map.size());
+        for (auto const& [key, position] : m_map)
+        {
+            result.push_back(position);
+        }
+        std::ranges::sort(result);
+        return result;
+    }
+
+private:
+    std::shared_ptr<arrow::DataType> m_type;
+    std::unordered_map<std::shared_ptr<arrow::Scalar>,
+                       int64_t,
+                       HashScalar,
+                       HashScalar>
+        m_map;
+};
+
+struct MakeFlatIndexer
+{
+    std::shared_ptr<arrow::Array> const& index;
+    std::shared_ptr<arrow::Array> const& storage;
+    std::shared_ptr<IndexerImpl const> result{};
+
+    template<class T>
+    arrow::Status Visit(T const&)
+    {
+        if constexpr (
+            (arrow::is_integer_type<T>::value or
+             arrow::is_floating_type<T>::value or
+             arrow::is_base_binary_type<T>::value) and
+            not std::same_as<T, arrow::HalfFloatType>)
+        {
+            result = std::make_shared<FlatIndexer<T>>(index, storage);
+        }
+        return arrow::Status::OK();
+    }
+};
+
+Indexer::Indexer(std::shared_ptr<arrow::Array> const& index)
+{
+    if (auto storage = storageType(index->type()))
+    {
+        auto view = viewAs(index, storage);
+        MakeFlatIndexer maker{ index, view };
+        if (arrow::VisitTypeInline(*storage, &maker).ok() and maker.result)
+        {
+            m_impl = std::move(maker.result);
+            return;
+        }
+    }
+    m_impl = std::make_shared<ScalarIndexer>(index);
+}
+
+std::vector<int64_t> Indexer::find(arrow::Array const& labels) const
+{
+    return m_impl ? m_impl->find(labels) :
+                    std::vector<int64_t>(labels.length(), -1);
+}
+
+std::shared_ptr<arrow::Int64Array> Indexer::takeIndices(
+    arrow::Array const& labels) const
+{
+    auto rows = find(labels);
+    auto length = static_cast<int64_t>(rows.size());
+    auto null_count = std::ranges::count(rows, -1);
+
+    std::shared_ptr<arrow::Buffer> validity;
+    if (null_count > 0)
+    {
+        validity = ReturnOrThrowOnFailure(arrow::AllocateEmptyBitmap(length));
+        auto bits = validity->mutable_data();
+        for (int64_t i = 0; i < length; i++)
+        {
+            if (rows[i] != -1)
+            {
+                arrow::bit_util::SetBit(bits, i);
+            }
+        }
+    }
+
+    return std::make_shared<arrow::Int64Array>(
+        length,
+        arrow::Buffer::FromVector(std::move(rows)),
+        validity,
+        null_count);
+}
+
+int64_t Indexer::at(std::shared_ptr<arrow::Scalar> const& label) const
+{
+    auto position = find(*label);
+    if (position == -1)
+    {
+        throw std::out_of_range(label->ToString() + " is not in the index");
+    }
+    return position;
+}
+
+}
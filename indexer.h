@@ -0,0 +1,110 @@
+#pragma once
+//
+// Created by dewe on 10/17/26.
+//
+#include <arrow/api.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+namespace pd {
+
+struct HashScalar{
+
+    bool operator()(std::shared_ptr<arrow::Scalar> const& a,
+                    std::shared_ptr<arrow::Scalar> const& b) const
+    {
+        return a->Equals(
+            b->CastTo(a->type).MoveValueUnsafe());
+    }
+
+    bool equal(std::shared_ptr<arrow::Scalar> const& a,
+                    std::shared_ptr<arrow::Scalar> const& b) const
+    {
+        return a->Equals(
+            b->CastTo(a->type).MoveValueUnsafe());
+    }
+
+    size_t operator()(std::shared_ptr<arrow::Scalar> const& scalar) const
+    {
+        return scalar->hash();
+    }
+
+    size_t hash(std::shared_ptr<arrow::Scalar> const& scalar) const
+    {
+        return scalar->hash();
+    }
+};
+
+/// A built label -> row position table, see Indexer.
+struct IndexerImpl
+{
+    virtual ~IndexerImpl() = default;
+
+    virtual size_t size() const = 0;
+
+    virtual int64_t find(arrow::Scalar const& label) const = 0;
+
+    virtual std::vector<int64_t> find(arrow::Array const& labels) const = 0;
+
+    virtual std::vector<int64_t> positions() const = 0;
+};
+
+/// Maps the values of an index array to their row position. Integer,
+/// floating point, temporal and string indexes get an open-addressing table
+/// specialized for their physical type, built in one pass over the raw
+/// buffers (hashed in parallel for large arrays); other types fall back to
+/// boxed scalars. Duplicated labels resolve to their last row and nulls are
+/// not indexed. Copies share the built table.
+class Indexer
+{
+public:
+    Indexer() = default;
+
+    explicit Indexer(std::shared_ptr<arrow::Array> const& index);
+
+    inline size_t size() const
+    {
+        return m_impl ? m_impl->size() : 0;
+    }
+
+    inline bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /// row of label, -1 when it is not indexed. label is cast to the index
+    /// type first
+    inline int64_t find(arrow::Scalar const& label) const
+    {
+        return m_impl ? m_impl->find(label) : -1;
+    }
+
+    /// row of every label, -1 where it is not indexed
+    std::vector<int64_t> find(arrow::Array const& labels) const;
+
+    inline bool contains(std::shared_ptr<arrow::Scalar> const& label) const
+    {
+        return find(*label) != -1;
+    }
+
+    /// int64 take indices selecting the row of every label, null where it is
+    /// not indexed, for arrow::compute::Take
+    std::shared_ptr<arrow::Int64Array> takeIndices(arrow::Array const& labels)
+        const;
+
+    /// throws std::out_of_range when label is not indexed
+    int64_t at(std::shared_ptr<arrow::Scalar> const& label) const;
+
+    /// rows holding the distinct labels, ascending
+    inline std::vector<int64_t> positions() const
+    {
+        return m_impl ? m_impl->positions() : std::vector<int64_t>{};
+    }
+
+private:
+    std::shared_ptr<IndexerImpl const> m_impl;
+};
+
+}
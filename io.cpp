@@ -0,0 +1,884 @@
+//
+// Created by dewe on 10/17/26.
+//
+#include "io.h"
+#include <algorithm>
+#include <arrow/compute/api.h>
+#include <arrow/csv/api.h>
+#include <arrow/dataset/api.h>
+#include <arrow/filesystem/localfs.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+#include <arrow/util/value_parsing.h>
+#include <numeric>
+#include <parquet/arrow/reader.h>
+#include <parquet/arrow/schema.h>
+#include <parquet/arrow/writer.h>
+#include <parquet/exception.h>
+#include <parquet/schema.h>
+#include <parquet/statistics.h>
+#include <parquet/types.h>
+#include "arrow/table.h"
+
+namespace pd {
+
+// schema metadata key naming the column toFeather/toParquet stored the index in
+constexpr auto PD_INDEX_METADATA_KEY = "pandas_arrow.index";
+
+// column name of an unnamed stored index, the one pandas itself uses
+constexpr auto PD_DEFAULT_INDEX_COLUMN = "__index_level_0__";
+
+/// the frame with its index appended as a column named in the schema metadata
+static std::shared_ptr<arrow::RecordBatch> withIndexColumn(
+    std::shared_ptr<arrow::RecordBatch> const& batch,
+    std::shared_ptr<arrow::Array> const& index,
+    std::optional<std::string> const& index_name)
+{
+    auto name = index_name.value_or(PD_DEFAULT_INDEX_COLUMN);
+    // a duplicated name could not be found again when reading the file back
+    if (not batch->schema()->GetFieldIndices(name).empty())
+    {
+        throw std::runtime_error(
+            "index column " + name + " collides with a column of the frame");
+    }
+    auto result = ReturnOrThrowOnFailure(
+        batch->AddColumn(batch->num_columns(), name, index));
+
+    auto metadata = result->schema()->metadata()
+        ? result->schema()->metadata()->Copy()
+        : std::make_shared<arrow::KeyValueMetadata>();
+    ThrowOnFailure(metadata->Set(PD_INDEX_METADATA_KEY, name));
+    return result->ReplaceSchemaMetadata(metadata);
+}
+
+/// moves the column named in the schema metadata back into the index.
+/// batches without one get defaultIndex (a positional index when null)
+static DataFrame restoreIndex(
+    std::shared_ptr<arrow::RecordBatch> batch,
+    std::shared_ptr<arrow::Array> const& defaultIndex = nullptr)
+{
+    auto metadata = batch->schema()->metadata();
+    if (not metadata or not metadata->Contains(PD_INDEX_METADATA_KEY))
+    {
+        return { batch, defaultIndex };
+    }
+
+    auto indexName =
+        ReturnOrThrowOnFailure(metadata->Get(PD_INDEX_METADATA_KEY));
+    auto i = batch->schema()->GetFieldIndex(indexName);
+    if (i == -1)
+    {
+        throw std::runtime_error("index column " + indexName + " is missing");
+    }
+    auto index = batch->column(i);
+    batch = ReturnOrThrowOnFailure(batch->RemoveColumn(i));
+
+    auto remaining = metadata->Copy();
+    ThrowOnFailure(remaining->Delete(PD_INDEX_METADATA_KEY));
+    batch = batch->ReplaceSchemaMetadata(
+        remaining->size() > 0 ? remaining : nullptr);
+
+    return { batch, index };
+}
+
+/// the name of the stored index column, if the schema has one
+static std::optional<std::string> indexColumnName(arrow::Schema const& schema)
+{
+    auto metadata = schema.metadata();
+    if (not metadata or not metadata->Contains(PD_INDEX_METADATA_KEY))
+    {
+        return std::nullopt;
+    }
+    return ReturnOrThrowOnFailure(metadata->Get(PD_INDEX_METADATA_KEY));
+}
+
+DataFrameBatchReader::DataFrameBatchReader(
+    std::unique_ptr<parquet::arrow::FileReader> fileReader,
+    std::shared_ptr<arrow::Schema> schema,
+    BatchProducer producer,
+    bool prefetch)
+    : m_fileReader(std::move(fileReader)),
+      m_schema(std::move(schema)),
+      m_producer(std::make_shared<BatchProducer>(std::move(producer))),
+      m_prefetch(prefetch)
+{
+    if (m_prefetch)
+    {
+        schedule();
+    }
+}
+
+DataFrameBatchReader& DataFrameBatchReader::operator=(
+    DataFrameBatchReader&& other) noexcept
+{
+    if (this != &other)
+    {
+        // the pending read decodes through the raw file reader, so it has to
+        // finish before that reader is replaced
+        if (m_pending.valid())
+        {
+            m_pending.wait();
+        }
+        m_pending = std::move(other.m_pending);
+        m_fileReader = std::move(other.m_fileReader);
+        m_schema = std::move(other.m_schema);
+        m_producer = std::move(other.m_producer);
+        m_prefetch = other.m_prefetch;
+        m_exhausted = other.m_exhausted;
+        m_rowOffset = other.m_rowOffset;
+    }
+    return *this;
+}
+
+void DataFrameBatchReader::schedule()
+{
+    // capture the producer by shared_ptr so a moved reader keeps it alive
+    m_pending = std::async(
+        std::launch::async,
+        [producer = m_producer] { return (*producer)(); });
+}
+
+std::optional<DataFrame> DataFrameBatchReader::next()
+{
+    if (m_exhausted)
+    {
+        return std::nullopt;
+    }
+
+    std::shared_ptr<arrow::RecordBatch> batch;
+    try
+    {
+        batch = ReturnOrThrowOnFailure(
+            m_prefetch ? m_pending.get() : (*m_producer)());
+    }
+    catch (...)
+    {
+        // the future is consumed, and there is no read to schedule after it
+        m_exhausted = true;
+        throw;
+    }
+    if (not batch)
+    {
+        m_exhausted = true;
+        return std::nullopt;
+    }
+
+    if (m_prefetch)
+    {
+        schedule();
+    }
+
+    uint64_t start = m_rowOffset;
+    m_rowOffset += batch->num_rows();
+    return restoreIndex(batch, range(start, m_rowOffset));
+}
+
+static std::unique_ptr<parquet::arrow::FileReader> openParquetFile(
+    std::filesystem::path const& path,
+    ParquetReadOptions const& options)
+{
+    parquet::ArrowReaderProperties properties;
+    properties.set_use_threads(options.use_threads);
+    // coalesce the column chunk reads of a row group into few large IOs
+    properties.set_pre_buffer(true);
+    if (options.batch_size > 0)
+    {
+        properties.set_batch_size(options.batch_size);
+    }
+
+    parquet::arrow::FileReaderBuilder builder;
+    PARQUET_THROW_NOT_OK(builder.OpenFile(path.string()));
+
+    std::unique_ptr<parquet::arrow::FileReader> reader;
+    PARQUET_THROW_NOT_OK(builder.memory_pool(arrow::default_memory_pool())
+                             ->properties(properties)
+                             ->Build(&reader));
+    return reader;
+}
+
+/// Which row groups and leaf columns of a file to decode, and how to turn a
+/// decoded batch into the requested rows and columns.
+struct ParquetScan
+{
+    std::vector<int> rowGroups;
+    // leaf column indices, empty decodes every column
+    std::vector<int> columnIndices;
+    // bound to the decoded schema
+    std::optional<arrow::compute::Expression> filter;
+    // number of leading decoded columns to keep, -1 keeps them all
+    int numOutputColumns{ -1 };
+    // file schema indices of the requested columns, each once and in order
+    std::vector<int> projection;
+
+    arrow::Result<std::shared_ptr<arrow::RecordBatch>> apply(
+        std::shared_ptr<arrow::RecordBatch> batch) const
+    {
+        if (filter)
+        {
+            ARROW_ASSIGN_OR_RAISE(
+                auto mask,
+                arrow::compute::ExecuteScalarExpression(
+                    *filter, *batch->schema(), batch));
+            if (mask.is_scalar())
+            {
+                ARROW_ASSIGN_OR_RAISE(
+                    mask,
+                    arrow::MakeArrayFromScalar(*mask.scalar(), batch->num_rows()));
+            }
+            ARROW_ASSIGN_OR_RAISE(auto filtered, arrow::compute::Filter(batch, mask));
+            batch = filtered.record_batch();
+        }
+
+        if (numOutputColumns >= 0 and numOutputColumns < batch->num_columns())
+        {
+            std::vector<int> keep(numOutputColumns);
+            std::iota(keep.begin(), keep.end(), 0);
+            return batch->SelectColumns(keep);
+        }
+        return batch;
+    }
+};
+
+static void collectLeaves(
+    parquet::arrow::SchemaField const& field,
+    std::vector<int>& leaves)
+{
+    if (field.is_leaf())
+    {
+        leaves.push_back(field.column_index);
+    }
+    for (auto const& child : field.children)
+    {
+        collectLeaves(child, leaves);
+    }
+}
+
+/// The min and max of physical statistics as scalars of the physical type,
+/// false for the physical types that are not pruned on (int96, fixed length)
+static bool statisticsAsScalars(
+    parquet::Statistics const& statistics,
+    std::shared_ptr<arrow::Scalar>& min,
+    std::shared_ptr<arrow::Scalar>& max)
+{
+    auto asScalars = [&]<class Scalar, class Statistics>(Statistics const& typed)
+    {
+        min = std::make_shared<Scalar>(typed.min());
+        max = std::make_shared<Scalar>(typed.max());
+        return true;
+    };
+    auto bytes = [](parquet::ByteArray const& value)
+    {
+        return std::make_shared<arrow::BinaryScalar>(arrow::Buffer::FromString(
+            std::string(reinterpret_cast<char const*>(value.ptr), value.len)));
+    };
+
+    switch (statistics.physical_type())
+    {
+        case parquet::Type::BOOLEAN:
+            return asScalars.operator()<arrow::BooleanScalar>(
+                static_cast<parquet::BoolStatistics const&>(statistics));
+        case parquet::Type::INT32:
+            return asScalars.operator()<arrow::Int32Scalar>(
+                static_cast<parquet::Int32Statistics const&>(statistics));
+        case parquet::Type::INT64:
+            return asScalars.operator()<arrow::Int64Scalar>(
+                static_cast<parquet::Int64Statistics const&>(statistics));
+        case parquet::Type::FLOAT:
+            return asScalars.operator()<arrow::FloatScalar>(
+                static_cast<parquet::FloatStatistics const&>(statistics));
+        case parquet::Type::DOUBLE:
+            return asScalars.operator()<arrow::DoubleScalar>(
+                static_cast<parquet::DoubleStatistics const&>(statistics));
+        case parquet::Type::BYTE_ARRAY:
+        {
+            auto const& typed =
+                static_cast<parquet::ByteArrayStatistics const&>(statistics);
+            min = bytes(typed.min());
+            max = bytes(typed.max());
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/// Whether the physical statistics of column, cast to type, are its values:
+/// unannotated, integer, string and date columns, and timestamps read in the
+/// unit they are stored in. Other annotations such as decimal store an
+/// encoding the cast would misread
+static bool castableStatistics(
+    parquet::ColumnDescriptor const& column,
+    arrow::DataType const& type)
+{
+    auto const& logical = column.logical_type();
+    if (logical == nullptr or logical->is_none() or logical->is_int() or
+        logical->is_string())
+    {
+        return true;
+    }
+    if (logical->is_date())
+    {
+        return type.id() == arrow::Type::DATE32;
+    }
+    if (logical->is_timestamp() and type.id() == arrow::Type::TIMESTAMP)
+    {
+        auto stored =
+            static_cast<parquet::TimestampLogicalType const&>(*logical).time_unit();
+        auto unit = static_cast<arrow::TimestampType const&>(type).unit();
+        return (stored == parquet::LogicalType::TimeUnit::MILLIS and
+                unit == arrow::TimeUnit::MILLI) or
+            (stored == parquet::LogicalType::TimeUnit::MICROS and
+             unit == arrow::TimeUnit::MICRO) or
+            (stored == parquet::LogicalType::TimeUnit::NANOS and
+             unit == arrow::TimeUnit::NANO);
+    }
+    return false;
+}
+
+/// What the statistics of one column chunk say about every value in it, in
+/// the form SimplifyWithGuarantee expects. std::nullopt when nothing is known.
+static std::optional<arrow::compute::Expression> statisticsGuarantee(
+    parquet::ColumnChunkMetaData const& chunk,
+    arrow::Field const& field)
+{
+    using namespace arrow::compute;
+
+    auto statistics = chunk.statistics();
+    if (not chunk.is_stats_set() or not statistics)
+    {
+        return std::nullopt;
+    }
+
+    auto ref = field_ref(field.name());
+    if (statistics->HasNullCount() and
+        statistics->null_count() == chunk.num_values())
+    {
+        return is_null(ref);
+    }
+    if (not statistics->HasMinMax())
+    {
+        return std::nullopt;
+    }
+
+    std::shared_ptr<arrow::Scalar> min, max;
+    if (not castableStatistics(*chunk.descr(), *field.type()) or
+        not statisticsAsScalars(*statistics, min, max))
+    {
+        return std::nullopt;
+    }
+    // physical statistics may be narrower than the logical arrow type; an
+    // unsigned column whose bounds do not fit the signed physical type fails
+    // to cast and is not pruned
+    auto minCast = Cast(min, field.type());
+    auto maxCast = Cast(max, field.type());
+    if (not minCast.ok() or not maxCast.ok())
+    {
+        return std::nullopt;
+    }
+
+    auto range = and_(
+        greater_equal(ref, literal(minCast->scalar())),
+        less_equal(ref, literal(maxCast->scalar())));
+    if (not statistics->HasNullCount() or statistics->null_count() > 0)
+    {
+        return or_(is_null(ref), range);
+    }
+    return range;
+}
+
+static ParquetScan planParquetScan(
+    parquet::arrow::FileReader& reader,
+    ParquetReadOptions const& options)
+{
+    std::shared_ptr<arrow::Schema> fileSchema;
+    PARQUET_THROW_NOT_OK(reader.GetSchema(&fileSchema));
+    auto const& manifest = reader.manifest();
+
+    auto fieldIndex = [&](std::string const& name)
+    {
+        auto i = fileSchema->GetFieldIndex(name);
+        if (i == -1)
+        {
+            throw std::runtime_error(
+                "column " + name + " is not in the parquet schema");
+        }
+        return i;
+    };
+
+    ParquetScan scan;
+
+    // requested columns first, so the projection is a prefix of the
+    // decoded batch and the filter-only columns can be sliced off
+    std::vector<int> fields;
+    for (auto const& name : options.columns)
+    {
+        // a column listed twice is decoded and returned once
+        auto i = fieldIndex(name);
+        if (std::find(fields.begin(), fields.end(), i) == fields.end())
+        {
+            fields.push_back(i);
+        }
+    }
+    scan.projection = fields;
+
+    std::vector<int> filterFields;
+    if (options.filter)
+    {
+        for (auto const& ref : arrow::compute::FieldsInExpression(*options.filter))
+        {
+            auto name = ref.name();
+            if (not name)
+            {
+                throw std::runtime_error(
+                    "parquet filter only supports top level column names");
+            }
+            filterFields.push_back(fieldIndex(*name));
+        }
+    }
+
+    if (not options.columns.empty())
+    {
+        // the stored index travels with any projection
+        if (auto indexName = indexColumnName(*fileSchema))
+        {
+            auto i = fileSchema->GetFieldIndex(*indexName);
+            if (i != -1 and std::find(fields.begin(), fields.end(), i) == fields.end())
+            {
+                fields.push_back(i);
+            }
+        }
+        scan.numOutputColumns = static_cast<int>(fields.size());
+        for (int i : filterFields)
+        {
+            if (std::find(fields.begin(), fields.end(), i) == fields.end())
+            {
+                fields.push_back(i);
+            }
+        }
+        for (int i : fields)
+        {
+            collectLeaves(manifest.schema_fields[i], scan.columnIndices);
+        }
+    }
+
+    std::shared_ptr<arrow::Schema> decodedSchema = fileSchema;
+    if (not fields.empty())
+    {
+        std::vector<std::shared_ptr<arrow::Field>> decodedFields;
+        for (int i : fields)
+        {
+            decodedFields.push_back(fileSchema->field(i));
+        }
+        decodedSchema = arrow::schema(decodedFields, fileSchema->metadata());
+    }
+
+    if (options.filter)
+    {
+        scan.filter = ReturnOrThrowOnFailure(options.filter->Bind(*decodedSchema));
+    }
+
+    auto metadata = reader.parquet_reader()->metadata();
+    for (int rowGroup = 0; rowGroup < metadata->num_row_groups(); rowGroup++)
+    {
+        if (scan.filter)
+        {
+            auto rowGroupMetadata = metadata->RowGroup(rowGroup);
+
+            std::vector<arrow::compute::Expression> guarantees;
+            for (int i : filterFields)
+            {
+                auto const& field = manifest.schema_fields[i];
+                if (not field.is_leaf())
+                {
+                    continue;
+                }
+                auto chunk = rowGroupMetadata->ColumnChunk(field.column_index);
+                if (auto guarantee = statisticsGuarantee(*chunk, *fileSchema->field(i)))
+                {
+                    guarantees.push_back(std::move(*guarantee));
+                }
+            }
+
+            if (not guarantees.empty())
+            {
+                auto guarantee = ReturnOrThrowOnFailure(
+                    arrow::compute::and_(guarantees).Bind(*decodedSchema));
+                auto simplified = ReturnOrThrowOnFailure(
+                    arrow::compute::SimplifyWithGuarantee(*scan.filter, guarantee));
+                if (not simplified.IsSatisfiable())
+                {
+                    continue;
+                }
+            }
+        }
+        scan.rowGroups.push_back(rowGroup);
+    }
+
+    return scan;
+}
+
+DataFrameBatchReader DataFrame::readParquetBatches(
+    std::filesystem::path const& path,
+    ParquetReadOptions const& options)
+{
+    auto fileReader = openParquetFile(path, options);
+    auto scan = std::make_shared<ParquetScan>(planParquetScan(*fileReader, options));
+
+    std::shared_ptr<arrow::Schema> schema;
+    PARQUET_THROW_NOT_OK(fileReader->GetSchema(&schema));
+    auto indexName = indexColumnName(*schema);
+    auto indexField = indexName ? schema->GetFieldIndex(*indexName) : -1;
+    if (scan->numOutputColumns >= 0)
+    {
+        // the same deduplicated projection the batches carry, the stored
+        // index being moved out of them
+        std::vector<std::shared_ptr<arrow::Field>> fields;
+        for (int i : scan->projection)
+        {
+            if (i != indexField)
+            {
+                fields.push_back(schema->field(i));
+            }
+        }
+        schema = arrow::schema(fields, schema->metadata());
+    }
+    else if (indexField != -1)
+    {
+        schema = ReturnOrThrowOnFailure(schema->RemoveField(indexField));
+    }
+
+    DataFrameBatchReader::BatchProducer decode;
+    if (options.batch_size > 0)
+    {
+        std::unique_ptr<arrow::RecordBatchReader> batchReader;
+        if (scan->columnIndices.empty())
+        {
+            PARQUET_THROW_NOT_OK(
+                fileReader->GetRecordBatchReader(scan->rowGroups, &batchReader));
+        }
+        else
+        {
+            PARQUET_THROW_NOT_OK(fileReader->GetRecordBatchReader(
+                scan->rowGroups, scan->columnIndices, &batchReader));
+        }
+
+        decode = [batchReader = std::shared_ptr<arrow::RecordBatchReader>(
+                      std::move(batchReader))]
+        { return batchReader->Next(); };
+    }
+    else
+    {
+        decode = [reader = fileReader.get(), scan, i = size_t{ 0 }]() mutable
+            -> arrow::Result<std::shared_ptr<arrow::RecordBatch>>
+        {
+            if (i == scan->rowGroups.size())
+            {
+                return std::shared_ptr<arrow::RecordBatch>{};
+            }
+            std::shared_ptr<arrow::Table> table;
+            if (scan->columnIndices.empty())
+            {
+                ARROW_RETURN_NOT_OK(
+                    reader->ReadRowGroup(scan->rowGroups[i++], &table));
+            }
+            else
+            {
+                ARROW_RETURN_NOT_OK(reader->ReadRowGroup(
+                    scan->rowGroups[i++], scan->columnIndices, &table));
+            }
+            return table->CombineChunksToBatch();
+        };
+    }
+
+    // filtering can empty a batch entirely, those are skipped
+    DataFrameBatchReader::BatchProducer producer =
+        [decode = std::move(decode), scan]() mutable
+        -> arrow::Result<std::shared_ptr<arrow::RecordBatch>>
+    {
+        while (true)
+        {
+            ARROW_ASSIGN_OR_RAISE(auto batch, decode());
+            if (not batch)
+            {
+                return batch;
+            }
+            ARROW_ASSIGN_OR_RAISE(batch, scan->apply(std::move(batch)));
+            if (batch->num_rows() > 0)
+            {
+                return batch;
+            }
+        }
+    };
+
+    return { std::move(fileReader),
+             std::move(schema),
+             std::move(producer),
+             options.prefetch };
+}
+
+DataFrame DataFrame::readParquet(
+    std::filesystem::path const& path,
+    ParquetReadOptions const& options)
+{
+    auto reader = openParquetFile(path, options);
+
+    if (reader->parquet_reader()->metadata()->num_rows() == 0)
+    {
+        throw std::runtime_error(
+            "Cannot Initialize DataFrame with empty parquet table");
+    }
+
+    auto scan = planParquetScan(*reader, options);
+
+    std::shared_ptr<arrow::Table> parquet_table;
+    if (scan.columnIndices.empty())
+    {
+        PARQUET_THROW_NOT_OK(reader->ReadRowGroups(scan.rowGroups, &parquet_table));
+    }
+    else
+    {
+        PARQUET_THROW_NOT_OK(reader->ReadRowGroups(
+            scan.rowGroups, scan.columnIndices, &parquet_table));
+    }
+
+    // row groups arrive as separate chunks, merge them into one batch
+    auto batch = ReturnOrThrowOnFailure(parquet_table->CombineChunksToBatch());
+    return restoreIndex(ReturnOrThrowOnFailure(scan.apply(std::move(batch))));
+}
+
+void DataFrame::toFeather(
+    std::filesystem::path const& path,
+    std::optional<std::string> const& index_name) const
+{
+    auto batch = withIndexColumn(m_array, m_index, index_name);
+
+    auto outfile =
+        ReturnOrThrowOnFailure(arrow::io::FileOutputStream::Open(path.string()));
+    auto writer = ReturnOrThrowOnFailure(
+        arrow::ipc::MakeFileWriter(outfile, batch->schema()));
+    ThrowOnFailure(writer->WriteRecordBatch(*batch));
+    ThrowOnFailure(writer->Close());
+    ThrowOnFailure(outfile->Close());
+}
+
+DataFrame DataFrame::readFeather(std::filesystem::path const& path, bool mmap)
+{
+    std::shared_ptr<arrow::io::RandomAccessFile> file;
+    if (mmap)
+    {
+        file = ReturnOrThrowOnFailure(arrow::io::MemoryMappedFile::Open(
+            path.string(), arrow::io::FileMode::READ));
+    }
+    else
+    {
+        file = ReturnOrThrowOnFailure(arrow::io::ReadableFile::Open(path.string()));
+    }
+
+    auto reader =
+        ReturnOrThrowOnFailure(arrow::ipc::RecordBatchFileReader::Open(file));
+
+    std::shared_ptr<arrow::RecordBatch> batch;
+    if (reader->num_record_batches() == 1)
+    {
+        // a single batch is returned as views into the file, no copy
+        batch = ReturnOrThrowOnFailure(reader->ReadRecordBatch(0));
+    }
+    else
+    {
+        arrow::RecordBatchVector batches(reader->num_record_batches());
+        for (int i = 0; i < reader->num_record_batches(); i++)
+        {
+            batches[i] = ReturnOrThrowOnFailure(reader->ReadRecordBatch(i));
+        }
+        auto table = ReturnOrThrowOnFailure(
+            arrow::Table::FromRecordBatches(reader->schema(), batches));
+        batch = ReturnOrThrowOnFailure(table->CombineChunksToBatch());
+    }
+
+    // files not written by toFeather get a default index
+    return restoreIndex(batch);
+}
+
+void DataFrame::toParquet(
+    std::filesystem::path const& path,
+    ParquetWriteOptions const& options) const
+{
+    auto batch = withIndexColumn(m_array, m_index, options.index_name);
+    auto table =
+        ReturnOrThrowOnFailure(arrow::Table::FromRecordBatches({ batch }));
+
+    parquet::WriterProperties::Builder properties;
+    properties.max_row_group_length(options.row_group_size);
+
+    properties.compression(options.compression);
+    for (auto const& [column, codec] : options.column_compression)
+    {
+        properties.compression(column, codec);
+    }
+
+    if (options.dictionary)
+    {
+        properties.enable_dictionary();
+    }
+    else
+    {
+        properties.disable_dictionary();
+    }
+    for (auto const& [column, enabled] : options.column_dictionary)
+    {
+        if (enabled)
+        {
+            properties.enable_dictionary(column);
+        }
+        else
+        {
+            properties.disable_dictionary(column);
+        }
+    }
+
+    if (options.statistics)
+    {
+        properties.enable_statistics();
+    }
+    else
+    {
+        properties.disable_statistics();
+    }
+
+    // store_schema keeps the index metadata and the exact arrow types
+    auto arrowProperties = parquet::ArrowWriterProperties::Builder()
+                               .store_schema()
+                               ->set_use_threads(options.use_threads)
+                               ->build();
+
+    auto outfile =
+        ReturnOrThrowOnFailure(arrow::io::FileOutputStream::Open(path.string()));
+    PARQUET_THROW_NOT_OK(parquet::arrow::WriteTable(
+        *table,
+        arrow::default_memory_pool(),
+        outfile,
+        options.row_group_size,
+        properties.build(),
+        arrowProperties));
+    PARQUET_THROW_NOT_OK(outfile->Close());
+}
+
+DataFrame read_csv(
+    std::filesystem::path const& path,
+    CsvReadOptions const& options)
+{
+    auto readOptions = arrow::csv::ReadOptions::Defaults();
+    readOptions.use_threads = options.use_threads;
+    readOptions.block_size = options.block_size;
+
+    auto parseOptions = arrow::csv::ParseOptions::Defaults();
+    parseOptions.delimiter = options.delimiter;
+
+    auto convertOptions = arrow::csv::ConvertOptions::Defaults();
+    for (auto const& [column, type] : options.dtype)
+    {
+        convertOptions.column_types[column] = type;
+    }
+    for (auto const& column : options.parse_dates)
+    {
+        convertOptions.column_types[column] =
+            arrow::timestamp(options.date_unit);
+    }
+    convertOptions.timestamp_parsers.push_back(
+        arrow::TimestampParser::MakeISO8601());
+    for (auto const& format : options.date_formats)
+    {
+        convertOptions.timestamp_parsers.push_back(
+            arrow::TimestampParser::MakeStrptime(format));
+    }
+
+    auto input =
+        ReturnOrThrowOnFailure(arrow::io::ReadableFile::Open(path.string()));
+    auto reader = ReturnOrThrowOnFailure(arrow::csv::TableReader::Make(
+        arrow::io::default_io_context(),
+        input,
+        readOptions,
+        parseOptions,
+        convertOptions));
+
+    auto table = ReturnOrThrowOnFailure(reader->Read());
+    DataFrame df{ ReturnOrThrowOnFailure(table->CombineChunksToBatch()) };
+
+    return options.index_col ? df.setIndex(*options.index_col) : df;
+}
+
+Dataset::Dataset(std::filesystem::path const& root)
+{
+    arrow::fs::FileSelector selector;
+    selector.base_dir = std::filesystem::absolute(root).string();
+    selector.recursive = true;
+
+    arrow::dataset::FileSystemFactoryOptions factoryOptions;
+    factoryOptions.partitioning =
+        arrow::dataset::HivePartitioning::MakeFactory();
+
+    auto factory =
+        ReturnOrThrowOnFailure(arrow::dataset::FileSystemDatasetFactory::Make(
+            std::make_shared<arrow::fs::LocalFileSystem>(),
+            selector,
+            std::make_shared<arrow::dataset::ParquetFileFormat>(),
+            factoryOptions));
+    m_dataset = ReturnOrThrowOnFailure(factory->Finish());
+}
+
+std::shared_ptr<arrow::Schema> Dataset::schema() const
+{
+    return m_dataset->schema();
+}
+
+static std::shared_ptr<arrow::dataset::Scanner> makeScanner(
+    arrow::dataset::Dataset& dataset,
+    DatasetScanOptions const& options)
+{
+    auto builder = ReturnOrThrowOnFailure(dataset.NewScan());
+    if (not options.columns.empty())
+    {
+        ThrowOnFailure(builder->Project(options.columns));
+    }
+    if (options.filter)
+    {
+        ThrowOnFailure(builder->Filter(*options.filter));
+    }
+    ThrowOnFailure(builder->BatchSize(options.batch_size));
+    ThrowOnFailure(builder->UseThreads(options.use_threads));
+    return ReturnOrThrowOnFailure(builder->Finish());
+}
+
+DataFrame Dataset::read(DatasetScanOptions const& options) const
+{
+    auto table =
+        ReturnOrThrowOnFailure(makeScanner(*m_dataset, options)->ToTable());
+    return restoreIndex(ReturnOrThrowOnFailure(table->CombineChunksToBatch()));
+}
+
+DataFrameBatchReader Dataset::readBatches(
+    DatasetScanOptions const& options) const
+{
+    auto scanner = makeScanner(*m_dataset, options);
+    std::shared_ptr<arrow::RecordBatchReader> batchReader =
+        ReturnOrThrowOnFailure(scanner->ToRecordBatchReader());
+
+    // scanned batches may be empty when a fragment has no matching rows
+    DataFrameBatchReader::BatchProducer producer =
+        [scanner, batchReader]()
+        -> arrow::Result<std::shared_ptr<arrow::RecordBatch>>
+    {
+        while (true)
+        {
+            ARROW_ASSIGN_OR_RAISE(auto batch, batchReader->Next());
+            if (not batch or batch->num_rows() > 0)
+            {
+                return batch;
+            }
+        }
+    };
+
+    return { nullptr, scanner->options()->projected_schema, std::move(producer), true };
+}
+
+}
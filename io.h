@@ -0,0 +1,121 @@
+#pragma once
+//
+// Created by dewe on 10/17/26.
+//
+
+#include <future>
+#include <optional>
+#include <unordered_map>
+#include <parquet/arrow/reader.h>
+#include "dataframe.h"
+
+namespace arrow::dataset {
+class Dataset;
+}
+
+namespace pd {
+
+/// Streams a Parquet file as a sequence of DataFrame batches, either one per
+/// row group or one per ParquetReadOptions::batch_size rows, or the batches
+/// of a Dataset scan (fileReader is then null). When prefetch is enabled the
+/// next batch is decoded on a background thread while the caller processes
+/// the current one, so at most two batches are resident at a time.
+class DataFrameBatchReader
+{
+public:
+    using BatchProducer =
+        std::function<arrow::Result<std::shared_ptr<arrow::RecordBatch>>()>;
+
+    DataFrameBatchReader(
+        std::unique_ptr<parquet::arrow::FileReader> fileReader,
+        std::shared_ptr<arrow::Schema> schema,
+        BatchProducer producer,
+        bool prefetch);
+
+    DataFrameBatchReader(DataFrameBatchReader&&) = default;
+    /// waits for the pending read of this reader before releasing its file
+    DataFrameBatchReader& operator=(DataFrameBatchReader&& other) noexcept;
+
+    /// Returns the next batch, or std::nullopt once the file is exhausted.
+    /// Batches are indexed by their row position in the file. A failed read
+    /// throws and ends the stream.
+    std::optional<DataFrame> next();
+
+    inline std::shared_ptr<arrow::Schema> schema() const
+    {
+        return m_schema;
+    }
+
+private:
+    // declared first so it is destroyed after the pending read and the producer
+    std::unique_ptr<parquet::arrow::FileReader> m_fileReader;
+    std::shared_ptr<arrow::Schema> m_schema;
+    std::shared_ptr<BatchProducer> m_producer;
+    bool m_prefetch{ true };
+    bool m_exhausted{ false };
+    uint64_t m_rowOffset{ 0 };
+    std::future<arrow::Result<std::shared_ptr<arrow::RecordBatch>>> m_pending;
+
+    void schedule();
+};
+
+/// Controls how read_csv parses a file.
+struct CsvReadOptions
+{
+    /// column name -> type, skips inference for those columns
+    std::unordered_map<std::string, std::shared_ptr<arrow::DataType>> dtype{};
+    /// column moved into the index, the same way DataFrame::setIndex does
+    std::optional<std::string> index_col{};
+    /// columns parsed as timestamps of date_unit
+    std::vector<std::string> parse_dates{};
+    /// strptime formats tried after ISO8601 when parsing timestamps
+    std::vector<std::string> date_formats{};
+    arrow::TimeUnit::type date_unit{ arrow::TimeUnit::NANO };
+    /// bytes per block, blocks are parsed and converted concurrently
+    int32_t block_size{ 1 << 20 };
+    bool use_threads{ true };
+    char delimiter{ ',' };
+};
+
+/// Reads a CSV file with a header row into a DataFrame, inferring the type of
+/// every column that is not listed in dtype or parse_dates.
+DataFrame read_csv(
+    std::filesystem::path const& path,
+    CsvReadOptions const& options = {});
+
+/// Controls which columns and rows a Dataset scan produces.
+struct DatasetScanOptions
+{
+    /// columns to load, partition keys included. empty loads every column
+    std::vector<std::string> columns{};
+    /// row predicate. partitions whose keys cannot satisfy it are never
+    /// opened, and Parquet row groups are pruned by their statistics
+    std::optional<arrow::compute::Expression> filter{};
+    /// maximum rows per scanned batch
+    int64_t batch_size{ 1 << 17 };
+    /// scan fragments concurrently
+    bool use_threads{ true };
+};
+
+/// A directory of Parquet files, partitioned hive style (root/date=.../
+/// symbol=.../part.parquet). Partition keys become columns with inferred
+/// types.
+class Dataset
+{
+public:
+    explicit Dataset(std::filesystem::path const& root);
+
+    std::shared_ptr<arrow::Schema> schema() const;
+
+    /// the matching rows of every fragment as one DataFrame
+    DataFrame read(DatasetScanOptions const& options = {}) const;
+
+    /// the matching rows as a stream of DataFrame batches
+    DataFrameBatchReader readBatches(
+        DatasetScanOptions const& options = {}) const;
+
+private:
+    std::shared_ptr<arrow::dataset::Dataset> m_dataset;
+};
+
+}
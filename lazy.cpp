@@ -0,0 +1,746 @@
+//
+// Created by dewe on 10/17/26.
+//
+#include "lazy.h"
+#include <arrow/util/bit_util.h>
+#include <limits>
+#include <tbb/parallel_for.h>
+
+
+namespace pd {
+
+// rows evaluated per step, the operand blocks of a whole tree stay in L1/L2
+constexpr int64_t PD_LAZY_BLOCK_SIZE = { 1024 };
+// rows per task, a multiple of 8 so tasks never share a validity byte
+constexpr int64_t PD_LAZY_TASK_ROWS = { 1 << 16 };
+
+using Node = LazyFrame::Node;
+
+LazyFrame::LazyFrame(DataFrame const& df)
+{
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Frame;
+    node->frame = df.array();
+    node->index = df.indexArray();
+    m_root = std::move(node);
+}
+
+LazyFrame::LazyFrame(Series const& series)
+{
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Column;
+    node->column = series.array();
+    node->name = series.name();
+    node->index = series.indexArray();
+    m_root = std::move(node);
+}
+
+LazyFrame::LazyFrame(Op op, LazyFrame const& a, LazyFrame const& b)
+{
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Binary;
+    node->op = op;
+    node->lhs = a.m_root;
+    node->rhs = b.m_root;
+    m_root = std::move(node);
+}
+
+LazyFrame DataFrame::lazy() const
+{
+    return *this;
+}
+
+LazyFrame Series::lazy() const
+{
+    return *this;
+}
+
+namespace {
+
+/// the expression of one output column, flattened in postfix order so every
+/// step reads the registers of steps before it
+struct Program
+{
+    struct Step
+    {
+        Node::Kind kind{ Node::Kind::Constant };
+        LazyFrame::Op op{ LazyFrame::Op::Add };
+        size_t lhs{ 0 }, rhs{ 0 };
+        std::shared_ptr<arrow::ArrayData> data;
+        bool nullable{ false };
+        int64_t intValue{ 0 };
+        double doubleValue{ 0 };
+    };
+
+    std::vector<Step> steps;
+    bool integral{ true };
+    bool nullable{ false };
+};
+
+/// output column names, row count and index, taken from the first DataFrame
+/// of the tree or, failing that, its first Series
+struct Layout
+{
+    std::vector<std::string> names;
+    std::shared_ptr<arrow::Array> index;
+    int64_t num_rows{ -1 };
+};
+
+void findLayout(Node const& node, Layout& layout, bool frames)
+{
+    if (not layout.names.empty())
+    {
+        return;
+    }
+
+    if (frames and node.kind == Node::Kind::Frame)
+    {
+        layout.names = node.frame->schema()->field_names();
+        layout.index = node.index;
+        layout.num_rows = node.frame->num_rows();
+    }
+    else if (not frames and node.kind == Node::Kind::Column)
+    {
+        layout.names = { node.name };
+        layout.index = node.index;
+        layout.num_rows = node.column->length();
+    }
+    else if (node.kind == Node::Kind::Binary)
+    {
+        findLayout(*node.lhs, layout, frames);
+        findLayout(*node.rhs, layout, frames);
+    }
+}
+
+Layout findLayout(Node const& root)
+{
+    Layout layout;
+    findLayout(root, layout, true);
+    findLayout(root, layout, false);
+    if (layout.names.empty())
+    {
+        throw std::runtime_error(
+            "a lazy expression needs at least one DataFrame or Series");
+    }
+    return layout;
+}
+
+size_t flatten(Node const& node, int column, int64_t num_rows, Program& program)
+{
+    Program::Step step;
+    step.kind = node.kind;
+
+    switch (node.kind)
+    {
+        case Node::Kind::Frame:
+        case Node::Kind::Column:
+        {
+            std::shared_ptr<arrow::Array> array;
+            if (node.kind == Node::Kind::Column)
+            {
+                array = node.column;
+            }
+            else if (column < node.frame->num_columns())
+            {
+                array = node.frame->column(column);
+            }
+            else
+            {
+                throw std::runtime_error(
+                    "lazy expression operands have different column counts");
+            }
+
+            auto const& type = array->type();
+            if (not arrow::is_integer(type->id()) and
+                not(arrow::is_floating(type->id()) and
+                    type->id() != arrow::Type::HALF_FLOAT))
+            {
+                throw std::runtime_error(
+                    "lazy expressions only support numeric columns, got " +
+                    type->ToString());
+            }
+            if (array->length() != num_rows)
+            {
+                throw std::runtime_error(
+                    "lazy expression operands have different lengths");
+            }
+
+            step.data = array->data();
+            step.nullable = array->null_count() > 0;
+            program.integral &= arrow::is_integer(type->id());
+            program.nullable |= step.nullable;
+            break;
+        }
+        case Node::Kind::Constant:
+            step.intValue = node.intValue;
+            step.doubleValue = node.doubleValue;
+            program.integral &= node.integral;
+            break;
+        case Node::Kind::Binary:
+            step.op = node.op;
+            step.lhs = flatten(*node.lhs, column, num_rows, program);
+            step.rhs = flatten(*node.rhs, column, num_rows, program);
+            break;
+        default:
+            // materialize() replaced every plan subtree by a Frame
+            throw std::logic_error("plan node in a lazy expression");
+    }
+
+    program.steps.push_back(std::move(step));
+    return program.steps.size() - 1;
+}
+
+template<class T, class ArrowType>
+T const* loadAs(arrow::ArrayData const& data, int64_t begin, int64_t n, T* scratch)
+{
+    using CType = typename ArrowType::c_type;
+    auto values = data.GetValues<CType>(1) + begin;
+    if constexpr (std::same_as<CType, T>)
+    {
+        // no conversion needed, read the arrow buffer in place
+        return values;
+    }
+    else
+    {
+        for (int64_t i = 0; i < n; i++)
+        {
+            scratch[i] = static_cast<T>(values[i]);
+        }
+        return scratch;
+    }
+}
+
+#define PD_LAZY_LOAD_CASE(TYPE)                                               \
+    case arrow::TYPE##Type::type_id:                                          \
+        return loadAs<T, arrow::TYPE##Type>(data, begin, n, scratch);
+
+template<class T>
+T const* load(arrow::ArrayData const& data, int64_t begin, int64_t n, T* scratch)
+{
+    switch (data.type->id())
+    {
+        PD_LAZY_LOAD_CASE(Int8)
+        PD_LAZY_LOAD_CASE(Int16)
+        PD_LAZY_LOAD_CASE(Int32)
+        PD_LAZY_LOAD_CASE(Int64)
+        PD_LAZY_LOAD_CASE(UInt8)
+        PD_LAZY_LOAD_CASE(UInt16)
+        PD_LAZY_LOAD_CASE(UInt32)
+        PD_LAZY_LOAD_CASE(UInt64)
+        PD_LAZY_LOAD_CASE(Float)
+        PD_LAZY_LOAD_CASE(Double)
+        default:
+            throw std::runtime_error(
+                "lazy expressions only support numeric columns, got " +
+                data.type->ToString());
+    }
+}
+
+#undef PD_LAZY_LOAD_CASE
+
+/// integer arithmetic wraps around like arrow's unchecked kernels
+template<class T>
+void applyOp(
+    LazyFrame::Op op,
+    T const* a,
+    T const* b,
+    T* out,
+    int64_t n,
+    uint8_t const* valid)
+{
+    using Op = LazyFrame::Op;
+    if constexpr (std::is_integral_v<T>)
+    {
+        using U = std::make_unsigned_t<T>;
+        switch (op)
+        {
+            case Op::Add:
+                for (int64_t i = 0; i < n; i++)
+                {
+                    out[i] = static_cast<T>(U(a[i]) + U(b[i]));
+                }
+                break;
+            case Op::Subtract:
+                for (int64_t i = 0; i < n; i++)
+                {
+                    out[i] = static_cast<T>(U(a[i]) - U(b[i]));
+                }
+                break;
+            case Op::Multiply:
+                for (int64_t i = 0; i < n; i++)
+                {
+                    out[i] = static_cast<T>(U(a[i]) * U(b[i]));
+                }
+                break;
+            case Op::Divide:
+                for (int64_t i = 0; i < n; i++)
+                {
+                    if (b[i] == 0)
+                    {
+                        if (not valid or valid[i])
+                        {
+                            throw std::runtime_error("divide by zero");
+                        }
+                        out[i] = 0;
+                    }
+                    else if (b[i] == -1)
+                    {
+                        out[i] = static_cast<T>(U(0) - U(a[i]));
+                    }
+                    else
+                    {
+                        out[i] = a[i] / b[i];
+                    }
+                }
+                break;
+        }
+    }
+    else
+    {
+        switch (op)
+        {
+            case Op::Add:
+                for (int64_t i = 0; i < n; i++)
+                {
+                    out[i] = a[i] + b[i];
+                }
+                break;
+            case Op::Subtract:
+                for (int64_t i = 0; i < n; i++)
+                {
+                    out[i] = a[i] - b[i];
+                }
+                break;
+            case Op::Multiply:
+                for (int64_t i = 0; i < n; i++)
+                {
+                    out[i] = a[i] * b[i];
+                }
+                break;
+            case Op::Divide:
+                for (int64_t i = 0; i < n; i++)
+                {
+                    out[i] = a[i] / b[i];
+                }
+                break;
+        }
+    }
+}
+
+/// runs a Program over blocks of PD_LAZY_BLOCK_SIZE rows, keeping one
+/// scratch block per step
+template<class T>
+class Evaluator
+{
+public:
+    explicit Evaluator(Program const& program)
+        : m_program(program),
+          m_scratch(program.steps.size() * PD_LAZY_BLOCK_SIZE),
+          m_registers(program.steps.size()),
+          m_valid(program.nullable ? PD_LAZY_BLOCK_SIZE : 0)
+    {
+        for (size_t s = 0; s < program.steps.size(); s++)
+        {
+            auto const& step = program.steps[s];
+            if (step.kind == Node::Kind::Constant)
+            {
+                T value = std::is_integral_v<T> ?
+                    static_cast<T>(step.intValue) :
+                    static_cast<T>(step.doubleValue);
+                std::fill_n(scratch(s), PD_LAZY_BLOCK_SIZE, value);
+                m_registers[s] = scratch(s);
+            }
+        }
+    }
+
+    /// evaluates rows [begin, begin + n), writing them to out when given.
+    /// Returns the values, valid() then holds the row validity
+    T const* run(int64_t begin, int64_t n, T* out)
+    {
+        if (m_program.nullable)
+        {
+            computeValidity(begin, n);
+        }
+
+        auto const& steps = m_program.steps;
+        auto last = steps.size() - 1;
+        for (size_t s = 0; s < steps.size(); s++)
+        {
+            auto const& step = steps[s];
+            switch (step.kind)
+            {
+                case Node::Kind::Frame:
+                case Node::Kind::Column:
+                    m_registers[s] = load<T>(*step.data, begin, n, scratch(s));
+                    break;
+                case Node::Kind::Constant:
+                    break;
+                case Node::Kind::Binary:
+                {
+                    T* target = (s == last and out) ? out : scratch(s);
+                    applyOp<T>(
+                        step.op,
+                        m_registers[step.lhs],
+                        m_registers[step.rhs],
+                        target,
+                        n,
+                        valid());
+                    m_registers[s] = target;
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        if (out and m_registers[last] != out)
+        {
+            std::copy_n(m_registers[last], n, out);
+        }
+        return m_registers[last];
+    }
+
+    /// one byte per row of the last block, nullptr when no operand has nulls
+    uint8_t const* valid() const
+    {
+        return m_program.nullable ? m_valid.data() : nullptr;
+    }
+
+private:
+    Program const& m_program;
+    std::vector<T> m_scratch;
+    std::vector<T const*> m_registers;
+    std::vector<uint8_t> m_valid;
+
+    T* scratch(size_t step)
+    {
+        return m_scratch.data() + step * PD_LAZY_BLOCK_SIZE;
+    }
+
+    void computeValidity(int64_t begin, int64_t n)
+    {
+        std::fill_n(m_valid.begin(), n, uint8_t{ 1 });
+        for (auto const& step : m_program.steps)
+        {
+            if (not step.nullable)
+            {
+                continue;
+            }
+            auto bitmap = step.data->buffers[0]->data();
+            auto offset = step.data->offset + begin;
+            for (int64_t i = 0; i < n; i++)
+            {
+                m_valid[i] &= arrow::bit_util::GetBit(bitmap, offset + i);
+            }
+        }
+    }
+};
+
+/// calls fn(column, begin, end) for every task of every column, in parallel
+template<class Fn>
+void forEachTask(size_t num_columns, int64_t num_rows, Fn&& fn)
+{
+    auto tasksPerColumn = std::max<int64_t>(
+        1, (num_rows + PD_LAZY_TASK_ROWS - 1) / PD_LAZY_TASK_ROWS);
+    tbb::parallel_for(
+        int64_t{ 0 },
+        static_cast<int64_t>(num_columns) * tasksPerColumn,
+        [&](int64_t task)
+        {
+            auto column = static_cast<size_t>(task / tasksPerColumn);
+            auto begin = (task % tasksPerColumn) * PD_LAZY_TASK_ROWS;
+            fn(column, begin, std::min(begin + PD_LAZY_TASK_ROWS, num_rows));
+        });
+}
+
+std::vector<Program> compile(Node const& root, Layout const& layout)
+{
+    std::vector<Program> programs(layout.names.size());
+    for (size_t i = 0; i < programs.size(); i++)
+    {
+        flatten(root, static_cast<int>(i), layout.num_rows, programs[i]);
+    }
+    return programs;
+}
+
+template<class T>
+void materialize(
+    Program const& program,
+    int64_t begin,
+    int64_t end,
+    T* values,
+    uint8_t* bitmap)
+{
+    Evaluator<T> evaluator(program);
+    for (int64_t row = begin; row < end; row += PD_LAZY_BLOCK_SIZE)
+    {
+        auto n = std::min(PD_LAZY_BLOCK_SIZE, end - row);
+        evaluator.run(row, n, values + row);
+        if (auto valid = evaluator.valid())
+        {
+            for (int64_t i = 0; i < n; i++)
+            {
+                arrow::bit_util::SetBitTo(bitmap, row + i, valid[i] != 0);
+            }
+        }
+    }
+}
+
+enum class Reduction
+{
+    Sum,
+    Mean,
+    Min,
+    Max
+};
+
+/// partial result of a reduction over some rows of one column
+struct Partial
+{
+    bool integral{ true };
+    int64_t count{ 0 };
+    uint64_t intSum{ 0 };
+    double doubleSum{ 0 };
+    int64_t intMin{ std::numeric_limits<int64_t>::max() };
+    int64_t intMax{ std::numeric_limits<int64_t>::min() };
+    double doubleMin{ std::numeric_limits<double>::infinity() };
+    double doubleMax{ -std::numeric_limits<double>::infinity() };
+
+    template<class T>
+    void add(T value, Reduction reduction)
+    {
+        count++;
+        switch (reduction)
+        {
+            case Reduction::Sum:
+            case Reduction::Mean:
+                if constexpr (std::is_integral_v<T>)
+                {
+                    intSum += static_cast<uint64_t>(value);
+                }
+                else
+                {
+                    doubleSum += value;
+                }
+                break;
+            case Reduction::Min:
+                if constexpr (std::is_integral_v<T>)
+                {
+                    intMin = std::min(intMin, value);
+                }
+                else
+                {
+                    doubleMin = std::min(doubleMin, value);
+                }
+                break;
+            case Reduction::Max:
+                if constexpr (std::is_integral_v<T>)
+                {
+                    intMax = std::max(intMax, value);
+                }
+                else
+                {
+                    doubleMax = std::max(doubleMax, value);
+                }
+                break;
+        }
+    }
+
+    void merge(Partial const& other)
+    {
+        integral &= other.integral;
+        count += other.count;
+        intSum += other.intSum;
+        doubleSum += other.doubleSum;
+        intMin = std::min(intMin, other.intMin);
+        intMax = std::max(intMax, other.intMax);
+        doubleMin = std::min(doubleMin, other.doubleMin);
+        doubleMax = std::max(doubleMax, other.doubleMax);
+    }
+};
+
+template<class T>
+Partial reduceRows(
+    Program const& program,
+    int64_t begin,
+    int64_t end,
+    Reduction reduction)
+{
+    Partial partial;
+    partial.integral = std::is_integral_v<T>;
+
+    Evaluator<T> evaluator(program);
+    for (int64_t row = begin; row < end; row += PD_LAZY_BLOCK_SIZE)
+    {
+        auto n = std::min(PD_LAZY_BLOCK_SIZE, end - row);
+        auto values = evaluator.run(row, n, nullptr);
+        auto valid = evaluator.valid();
+        for (int64_t i = 0; i < n; i++)
+        {
+            if (not valid or valid[i])
+            {
+                partial.add(values[i], reduction);
+            }
+        }
+    }
+    return partial;
+}
+
+}
+
+DataFrame LazyFrame::evaluate() const
+{
+    if (m_root->isPlan())
+    {
+        return collect();
+    }
+
+    auto root = materialize(m_root);
+    auto layout = findLayout(*root);
+    auto programs = compile(*root, layout);
+    auto num_rows = layout.num_rows;
+
+    std::vector<std::shared_ptr<arrow::Buffer>> values(programs.size());
+    std::vector<std::shared_ptr<arrow::Buffer>> bitmaps(programs.size());
+    for (size_t i = 0; i < programs.size(); i++)
+    {
+        auto width = programs[i].integral ? sizeof(int64_t) : sizeof(double);
+        values[i] = ReturnOrThrowOnFailure(arrow::AllocateBuffer(num_rows * width));
+        if (programs[i].nullable)
+        {
+            bitmaps[i] = ReturnOrThrowOnFailure(arrow::AllocateEmptyBitmap(num_rows));
+        }
+    }
+
+    forEachTask(
+        programs.size(),
+        num_rows,
+        [&](size_t column, int64_t begin, int64_t end)
+        {
+            auto bitmap =
+                bitmaps[column] ? bitmaps[column]->mutable_data() : nullptr;
+            if (programs[column].integral)
+            {
+                materialize(
+                    programs[column],
+                    begin,
+                    end,
+                    reinterpret_cast<int64_t*>(values[column]->mutable_data()),
+                    bitmap);
+            }
+            else
+            {
+                materialize(
+                    programs[column],
+                    begin,
+                    end,
+                    reinterpret_cast<double*>(values[column]->mutable_data()),
+                    bitmap);
+            }
+        });
+
+    arrow::FieldVector fields(programs.size());
+    arrow::ArrayDataVector columns(programs.size());
+    for (size_t i = 0; i < programs.size(); i++)
+    {
+        auto type = programs[i].integral ? arrow::int64() : arrow::float64();
+        fields[i] = arrow::field(layout.names[i], type);
+        columns[i] = arrow::ArrayData::Make(
+            type,
+            num_rows,
+            { bitmaps[i], values[i] },
+            bitmaps[i] ? arrow::kUnknownNullCount : 0);
+    }
+
+    return { arrow::schema(fields), num_rows, columns, layout.index };
+}
+
+static Partial reduceAll(
+    std::shared_ptr<Node const> const& root,
+    Reduction reduction)
+{
+    // root was materialized, every leaf is data
+    auto layout = findLayout(*root);
+    auto programs = compile(*root, layout);
+
+    auto tasksPerColumn = std::max<int64_t>(
+        1, (layout.num_rows + PD_LAZY_TASK_ROWS - 1) / PD_LAZY_TASK_ROWS);
+    std::vector<Partial> partials(programs.size() * tasksPerColumn);
+
+    forEachTask(
+        programs.size(),
+        layout.num_rows,
+        [&](size_t column, int64_t begin, int64_t end)
+        {
+            auto& partial = partials
+                [column * tasksPerColumn + begin / PD_LAZY_TASK_ROWS];
+            partial = programs[column].integral ?
+                reduceRows<int64_t>(programs[column], begin, end, reduction) :
+                reduceRows<double>(programs[column], begin, end, reduction);
+        });
+
+    // merged in task order, the floating point result does not depend on
+    // the scheduling
+    Partial result;
+    for (auto const& partial : partials)
+    {
+        result.merge(partial);
+    }
+    return result;
+}
+
+Scalar LazyFrame::sum() const
+{
+    auto result = reduceAll(materialize(m_root), Reduction::Sum);
+    if (result.integral)
+    {
+        return result.count == 0 ?
+            arrow::MakeNullScalar(arrow::int64()) :
+            arrow::MakeScalar(static_cast<int64_t>(result.intSum));
+    }
+    return result.count == 0 ?
+        arrow::MakeNullScalar(arrow::float64()) :
+        arrow::MakeScalar(
+            result.doubleSum + static_cast<double>(int64_t(result.intSum)));
+}
+
+Scalar LazyFrame::mean() const
+{
+    auto result = reduceAll(materialize(m_root), Reduction::Mean);
+    if (result.count == 0)
+    {
+        return arrow::MakeNullScalar(arrow::float64());
+    }
+    auto total = result.doubleSum + static_cast<double>(int64_t(result.intSum));
+    return arrow::MakeScalar(total / static_cast<double>(result.count));
+}
+
+Scalar LazyFrame::min() const
+{
+    auto result = reduceAll(materialize(m_root), Reduction::Min);
+    if (result.integral)
+    {
+        return result.count == 0 ? arrow::MakeNullScalar(arrow::int64()) :
+                                   arrow::MakeScalar(result.intMin);
+    }
+    return result.count == 0 ?
+        arrow::MakeNullScalar(arrow::float64()) :
+        arrow::MakeScalar(std::min(
+            result.doubleMin, static_cast<double>(result.intMin)));
+}
+
+Scalar LazyFrame::max() const
+{
+    auto result = reduceAll(materialize(m_root), Reduction::Max);
+    if (result.integral)
+    {
+        return result.count == 0 ? arrow::MakeNullScalar(arrow::int64()) :
+                                   arrow::MakeScalar(result.intMax);
+    }
+    return result.count == 0 ?
+        arrow::MakeNullScalar(arrow::float64()) :
+        arrow::MakeScalar(std::max(
+            result.doubleMax, static_cast<double>(result.intMax)));
+}
+
+}
@@ -0,0 +1,211 @@
+#pragma once
+//
+// Created by dewe on 10/17/26.
+//
+
+#include "dataframe.h"
+#include "series.h"
+
+
+namespace pd {
+
+/// A deferred computation over DataFrames, Series and Parquet files.
+///
+/// Element-wise arithmetic between frames, series and numeric constants
+/// only grows an expression tree; evaluate() and the reductions then run the
+/// whole tree in one pass per column, a cache sized block of rows at a time,
+/// so no full size intermediate is ever materialized:
+///
+///     auto total = (((df.lazy() + df) * df) / df).sum();
+///
+/// DataFrame operands contribute their i-th column to the i-th output column
+/// and Series operands are broadcast to every column, as with the eager
+/// operators. Columns with only integer operands evaluate in int64 (integer
+/// division truncates and throws on a zero divisor, like arrow's "divide"),
+/// anything else in double. A null operand makes the row null.
+///
+/// select, where, assign, slice, sort_values and group_by record a logical
+/// plan instead. collect() pushes filters towards the source (through
+/// selections, sorts, assignments of other columns and group keys, merging
+/// consecutive ones, down into scanParquet), prunes the columns nothing
+/// reads, and runs the filter/project/aggregate stages on an arrow ExecPlan:
+///
+///     auto top = LazyFrame::scanParquet("trades.parquet")
+///                    .assign("notional = price * qty")
+///                    .group_by({ "symbol" }, { { "notional", "sum" } })
+///                    .where("symbol != 'TEST'")
+///                    .collect();
+///
+/// Row labels follow the rows through filters, sorts and slices; aggregated
+/// frames get a default index.
+class LazyFrame
+{
+public:
+    enum class Op
+    {
+        Add,
+        Subtract,
+        Multiply,
+        Divide
+    };
+
+    LazyFrame(DataFrame const& df);
+
+    LazyFrame(Series const& series);
+
+    template<class T>
+        requires std::is_arithmetic_v<T>
+    LazyFrame(T constant)
+    {
+        auto node = std::make_shared<Node>();
+        node->kind = Node::Kind::Constant;
+        node->integral = std::is_integral_v<T>;
+        node->intValue = static_cast<int64_t>(constant);
+        node->doubleValue = static_cast<double>(constant);
+        m_root = std::move(node);
+    }
+
+    /// a plan reading path with DataFrame::readParquet, selected columns and
+    /// filters above it are read and applied by the scan
+    static LazyFrame scanParquet(std::filesystem::path const& path);
+
+    /// runs the expression and materializes one column per output column,
+    /// same as collect() for plans
+    [[nodiscard]] DataFrame evaluate() const;
+
+    /// optimizes and runs the plan, evaluating any arithmetic it reads from
+    [[nodiscard]] DataFrame collect() const;
+
+    /// the optimized plan collect() would run, one node per line
+    [[nodiscard]] std::string explain() const;
+
+    // logical plan
+    [[nodiscard]] LazyFrame select(std::vector<std::string> const& columns) const;
+    /// condition is parsed by parseExpression, e.g. "price > 10 and qty < 5"
+    [[nodiscard]] LazyFrame where(std::string const& condition) const;
+    [[nodiscard]] LazyFrame where(arrow::compute::Expression const& condition)
+        const;
+    /// adds or replaces a column, e.g. "notional = price * qty"
+    [[nodiscard]] LazyFrame assign(std::string const& expression) const;
+    [[nodiscard]] LazyFrame slice(int64_t offset, int64_t length) const;
+    /// sorts the rows lexicographically by the columns of by
+    [[nodiscard]] LazyFrame sort_values(
+        std::vector<std::string> const& by,
+        bool ascending = true) const;
+    /// one row per distinct keys, with a column per (column, function) of
+    /// aggregations. functions are arrow's sum, mean, min, max, count,
+    /// count_distinct, product, stddev, variance, any and all. The column
+    /// keeps its name unless it is aggregated more than once, then it is
+    /// named column_function. The key columns come first
+    [[nodiscard]] LazyFrame group_by(
+        std::vector<std::string> const& keys,
+        std::vector<std::pair<std::string, std::string>> const& aggregations)
+        const;
+
+    // reductions over every value of every column, fused into the same pass
+    [[nodiscard]] Scalar sum() const;
+    [[nodiscard]] Scalar mean() const;
+    [[nodiscard]] Scalar min() const;
+    [[nodiscard]] Scalar max() const;
+
+    friend LazyFrame operator+(LazyFrame const& a, LazyFrame const& b)
+    {
+        return { Op::Add, a, b };
+    }
+
+    friend LazyFrame operator-(LazyFrame const& a, LazyFrame const& b)
+    {
+        return { Op::Subtract, a, b };
+    }
+
+    friend LazyFrame operator*(LazyFrame const& a, LazyFrame const& b)
+    {
+        return { Op::Multiply, a, b };
+    }
+
+    friend LazyFrame operator/(LazyFrame const& a, LazyFrame const& b)
+    {
+        return { Op::Divide, a, b };
+    }
+
+    struct Node
+    {
+        enum class Kind
+        {
+            // arithmetic
+            Frame,
+            Column,
+            Constant,
+            Binary,
+            // logical plan
+            Scan,
+            Select,
+            Filter,
+            Assign,
+            Slice,
+            Sort,
+            Aggregate
+        };
+
+        Kind kind{ Kind::Constant };
+
+        // Frame
+        std::shared_ptr<arrow::RecordBatch> frame;
+        // Column, the index and name are used when no Frame is in the tree.
+        // Assign stores its target in name
+        std::shared_ptr<arrow::Array> column;
+        std::string name;
+        // Frame and Column
+        std::shared_ptr<arrow::Array> index;
+
+        // Constant
+        bool integral{ false };
+        int64_t intValue{ 0 };
+        double doubleValue{ 0 };
+
+        // Binary
+        Op op{ Op::Add };
+        std::shared_ptr<Node const> lhs, rhs;
+
+        // the input of every plan node but Scan
+        std::shared_ptr<Node const> input;
+        // Scan
+        std::filesystem::path path;
+        // Scan (pruned columns), Select, Sort and Aggregate keys
+        std::vector<std::string> columns;
+        // Filter, Assign and the pushed down filter of Scan
+        std::optional<arrow::compute::Expression> expression;
+        // Slice
+        int64_t offset{ 0 };
+        int64_t length{ 0 };
+        // Sort
+        bool ascending{ true };
+        // Aggregate, (column, function)
+        std::vector<std::pair<std::string, std::string>> aggregations;
+
+        inline bool isPlan() const
+        {
+            return kind >= Kind::Scan;
+        }
+    };
+
+private:
+    std::shared_ptr<Node const> m_root;
+
+    explicit LazyFrame(std::shared_ptr<Node const> root);
+
+    LazyFrame(Op op, LazyFrame const& a, LazyFrame const& b);
+
+    /// node on top of this plan
+    LazyFrame then(std::shared_ptr<Node> node) const;
+
+    /// the plan with its arithmetic inputs evaluated into Frames
+    static std::shared_ptr<Node const> evaluateInputs(
+        std::shared_ptr<Node const> const& node);
+
+    /// the tree with every plan subtree replaced by its collected Frame
+    static std::shared_ptr<Node const> materialize(
+        std::shared_ptr<Node const> const& node);
+};
+
+}
@@ -0,0 +1,686 @@
+//
+// Created by dewe on 10/17/26.
+//
+#include <algorithm>
+#include <arrow/compute/api.h>
+#include <arrow/compute/exec/exec_plan.h>
+#include <arrow/compute/exec/options.h>
+#include <sstream>
+#include "eval.h"
+#include "lazy.h"
+
+
+namespace pd {
+
+namespace cp = arrow::compute;
+
+using Node = LazyFrame::Node;
+using NodePtr = std::shared_ptr<Node const>;
+
+// row labels travel through the plan as a regular column under this name
+constexpr char const* PD_LAZY_INDEX = "__pd_lazy_index__";
+// row positions, restoring the input order after a parallel ExecPlan
+constexpr char const* PD_LAZY_ROW = "__pd_lazy_row__";
+
+LazyFrame::LazyFrame(std::shared_ptr<Node const> root) : m_root(std::move(root))
+{
+}
+
+LazyFrame LazyFrame::then(std::shared_ptr<Node> node) const
+{
+    node->input = m_root;
+    return LazyFrame{ NodePtr{ std::move(node) } };
+}
+
+LazyFrame LazyFrame::scanParquet(std::filesystem::path const& path)
+{
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Scan;
+    node->path = path;
+    return LazyFrame{ NodePtr{ std::move(node) } };
+}
+
+LazyFrame LazyFrame::select(std::vector<std::string> const& columns) const
+{
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Select;
+    node->columns = columns;
+    return then(std::move(node));
+}
+
+LazyFrame LazyFrame::where(std::string const& condition) const
+{
+    auto parsed = parseExpression(condition);
+    if (parsed.target)
+    {
+        throw std::runtime_error(
+            "where expects a condition, got the assignment '" + condition + "'");
+    }
+    return where(parsed.expression);
+}
+
+LazyFrame LazyFrame::where(cp::Expression const& condition) const
+{
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Filter;
+    node->expression = condition;
+    return then(std::move(node));
+}
+
+LazyFrame LazyFrame::assign(std::string const& expression) const
+{
+    auto parsed = parseExpression(expression);
+    if (not parsed.target)
+    {
+        throw std::runtime_error(
+            "assign expects 'name = expression', got '" + expression + "'");
+    }
+
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Assign;
+    node->name = *parsed.target;
+    node->expression = parsed.expression;
+    return then(std::move(node));
+}
+
+LazyFrame LazyFrame::slice(int64_t offset, int64_t length) const
+{
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Slice;
+    node->offset = offset;
+    node->length = length;
+    return then(std::move(node));
+}
+
+LazyFrame LazyFrame::sort_values(
+    std::vector<std::string> const& by,
+    bool ascending) const
+{
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Sort;
+    node->columns = by;
+    node->ascending = ascending;
+    return then(std::move(node));
+}
+
+LazyFrame LazyFrame::group_by(
+    std::vector<std::string> const& keys,
+    std::vector<std::pair<std::string, std::string>> const& aggregations) const
+{
+    auto node = std::make_shared<Node>();
+    node->kind = Node::Kind::Aggregate;
+    node->columns = keys;
+    node->aggregations = aggregations;
+    return then(std::move(node));
+}
+
+namespace {
+
+std::vector<std::string> referencedColumns(cp::Expression const& expression)
+{
+    std::vector<std::string> names;
+    for (auto const& ref : cp::FieldsInExpression(expression))
+    {
+        if (auto name = ref.name())
+        {
+            names.push_back(*name);
+        }
+    }
+    return names;
+}
+
+bool contains(std::vector<std::string> const& names, std::string const& name)
+{
+    return std::ranges::find(names, name) != names.end();
+}
+
+bool containsAll(
+    std::vector<std::string> const& names,
+    std::vector<std::string> const& subset)
+{
+    return std::ranges::all_of(
+        subset,
+        [&](std::string const& name) { return contains(names, name); });
+}
+
+void addUnique(std::vector<std::string>& names, std::vector<std::string> const& more)
+{
+    for (auto const& name : more)
+    {
+        if (not contains(names, name))
+        {
+            names.push_back(name);
+        }
+    }
+}
+
+NodePtr withInput(Node const& node, NodePtr input)
+{
+    auto copy = std::make_shared<Node>(node);
+    copy->input = std::move(input);
+    return copy;
+}
+
+/// filter placed as close to the source below node as stays equivalent
+NodePtr pushFilter(NodePtr const& node, cp::Expression const& filter)
+{
+    auto refs = referencedColumns(filter);
+    switch (node->kind)
+    {
+        case Node::Kind::Scan:
+        {
+            auto copy = std::make_shared<Node>(*node);
+            copy->expression = node->expression ?
+                cp::and_(*node->expression, filter) :
+                filter;
+            return copy;
+        }
+        case Node::Kind::Filter:
+            // consecutive filters become one conjunction
+            return pushFilter(node->input, cp::and_(*node->expression, filter));
+        case Node::Kind::Sort:
+            return withInput(*node, pushFilter(node->input, filter));
+        case Node::Kind::Select:
+            if (containsAll(node->columns, refs))
+            {
+                return withInput(*node, pushFilter(node->input, filter));
+            }
+            break;
+        case Node::Kind::Assign:
+            if (not contains(refs, node->name))
+            {
+                return withInput(*node, pushFilter(node->input, filter));
+            }
+            break;
+        case Node::Kind::Aggregate:
+            // a condition on the keys drops whole groups, before or after
+            if (containsAll(node->columns, refs))
+            {
+                return withInput(*node, pushFilter(node->input, filter));
+            }
+            break;
+        default:
+            break;
+    }
+
+    auto result = std::make_shared<Node>();
+    result->kind = Node::Kind::Filter;
+    result->expression = filter;
+    result->input = node;
+    return result;
+}
+
+NodePtr pushFilters(NodePtr const& node)
+{
+    if (not node->isPlan() or node->kind == Node::Kind::Scan)
+    {
+        return node;
+    }
+
+    auto input = pushFilters(node->input);
+    if (node->kind == Node::Kind::Filter)
+    {
+        return pushFilter(input, *node->expression);
+    }
+    return withInput(*node, std::move(input));
+}
+
+/// drops the columns nothing above node reads, required empty reads all
+NodePtr pruneColumns(
+    NodePtr const& node,
+    std::optional<std::vector<std::string>> required)
+{
+    switch (node->kind)
+    {
+        case Node::Kind::Scan:
+        {
+            if (not required)
+            {
+                return node;
+            }
+            // the scan reads the columns of its own filter by itself
+            auto copy = std::make_shared<Node>(*node);
+            copy->columns = *required;
+            return copy;
+        }
+        case Node::Kind::Frame:
+        {
+            if (not required)
+            {
+                return node;
+            }
+            std::vector<int> indices;
+            for (auto const& name : *required)
+            {
+                auto i = node->frame->schema()->GetFieldIndex(name);
+                if (i == -1)
+                {
+                    throw std::runtime_error(name + " is not in the columns");
+                }
+                indices.push_back(i);
+            }
+            auto copy = std::make_shared<Node>(*node);
+            copy->frame = ReturnOrThrowOnFailure(node->frame->SelectColumns(indices));
+            return copy;
+        }
+        case Node::Kind::Select:
+        {
+            std::vector<std::string> columns;
+            for (auto const& name : node->columns)
+            {
+                if (not required or contains(*required, name))
+                {
+                    columns.push_back(name);
+                }
+            }
+            auto copy = std::make_shared<Node>(*node);
+            copy->columns = columns;
+            copy->input = pruneColumns(node->input, columns);
+            return copy;
+        }
+        case Node::Kind::Filter:
+            if (required)
+            {
+                addUnique(*required, referencedColumns(*node->expression));
+            }
+            return withInput(*node, pruneColumns(node->input, required));
+        case Node::Kind::Assign:
+            if (required)
+            {
+                if (not contains(*required, node->name))
+                {
+                    // nothing reads the assigned column
+                    return pruneColumns(node->input, required);
+                }
+                std::erase(*required, node->name);
+                addUnique(*required, referencedColumns(*node->expression));
+            }
+            return withInput(*node, pruneColumns(node->input, required));
+        case Node::Kind::Sort:
+            if (required)
+            {
+                addUnique(*required, node->columns);
+            }
+            return withInput(*node, pruneColumns(node->input, required));
+        case Node::Kind::Slice:
+            return withInput(*node, pruneColumns(node->input, required));
+        case Node::Kind::Aggregate:
+        {
+            std::vector<std::string> columns = node->columns;
+            for (auto const& [column, function] : node->aggregations)
+            {
+                addUnique(columns, { column });
+            }
+            return withInput(*node, pruneColumns(node->input, columns));
+        }
+        default:
+            // arithmetic reads every column of its frames
+            return node;
+    }
+}
+
+NodePtr optimize(NodePtr const& root)
+{
+    return pruneColumns(pushFilters(root), std::nullopt);
+}
+
+std::shared_ptr<arrow::Table> withIndex(DataFrame const& df)
+{
+    auto index = df.indexArray();
+    auto batch = ReturnOrThrowOnFailure(df.array()->AddColumn(
+        df.array()->num_columns(),
+        arrow::field(PD_LAZY_INDEX, index->type()),
+        index));
+    return ReturnOrThrowOnFailure(arrow::Table::FromRecordBatches({ batch }));
+}
+
+DataFrame toDataFrame(std::shared_ptr<arrow::Table> const& table)
+{
+    auto batch = ReturnOrThrowOnFailure(table->CombineChunksToBatch());
+    auto i = batch->schema()->GetFieldIndex(PD_LAZY_INDEX);
+    if (i == -1)
+    {
+        return { batch, nullptr };
+    }
+    auto index = batch->column(i);
+    return { ReturnOrThrowOnFailure(batch->RemoveColumn(i)), index };
+}
+
+bool isExecPlanStage(Node::Kind kind)
+{
+    return kind == Node::Kind::Select or kind == Node::Kind::Filter or
+        kind == Node::Kind::Assign or kind == Node::Kind::Aggregate;
+}
+
+std::shared_ptr<arrow::Table> execute(NodePtr const& node);
+
+/// the Filter/Assign/Select/Aggregate stages ending at node, as one ExecPlan
+std::shared_ptr<arrow::Table> executeStages(NodePtr const& node)
+{
+    std::vector<Node const*> stages;
+    auto source = node;
+    while (isExecPlanStage(source->kind))
+    {
+        stages.push_back(source.get());
+        source = source->input;
+    }
+    std::ranges::reverse(stages);
+
+    // the plan runs batches in parallel, the positions restore the order. An
+    // aggregate keeps the first position of every group, so groups come out
+    // in order of first appearance like the eager GroupBy
+    auto table = execute(source);
+    auto rows = range(uint64_t{ 0 }, static_cast<uint64_t>(table->num_rows()));
+    table = ReturnOrThrowOnFailure(table->AddColumn(
+        table->num_columns(),
+        arrow::field(PD_LAZY_ROW, rows->type()),
+        std::make_shared<arrow::ChunkedArray>(rows)));
+
+    // the index and row columns ride along at the end
+    auto names = table->schema()->field_names();
+    auto hidden = [](std::string const& name)
+    { return name == PD_LAZY_INDEX or name == PD_LAZY_ROW; };
+    auto project = [&](std::vector<cp::Expression> expressions,
+                       std::vector<std::string> outputs)
+    {
+        for (auto const& name : names)
+        {
+            if (hidden(name))
+            {
+                expressions.push_back(cp::field_ref(name));
+                outputs.push_back(name);
+            }
+        }
+        names = outputs;
+        return cp::Declaration{
+            "project",
+            cp::ProjectNodeOptions{ std::move(expressions), std::move(outputs) }
+        };
+    };
+
+    std::vector<cp::Declaration> declarations{
+        { "table_source", cp::TableSourceNodeOptions{ table } }
+    };
+    for (auto const* stage : stages)
+    {
+        switch (stage->kind)
+        {
+            case Node::Kind::Filter:
+                declarations.emplace_back(
+                    "filter", cp::FilterNodeOptions{ *stage->expression });
+                break;
+            case Node::Kind::Select:
+            {
+                std::vector<cp::Expression> expressions;
+                for (auto const& column : stage->columns)
+                {
+                    expressions.push_back(cp::field_ref(column));
+                }
+                declarations.push_back(project(expressions, stage->columns));
+                break;
+            }
+            case Node::Kind::Assign:
+            {
+                std::vector<cp::Expression> expressions;
+                std::vector<std::string> outputs;
+                for (auto const& name : names)
+                {
+                    if (not hidden(name))
+                    {
+                        expressions.push_back(
+                            name == stage->name ? *stage->expression :
+                                                  cp::field_ref(name));
+                        outputs.push_back(name);
+                    }
+                }
+                if (not contains(outputs, stage->name))
+                {
+                    expressions.push_back(*stage->expression);
+                    outputs.push_back(stage->name);
+                }
+                declarations.push_back(project(expressions, outputs));
+                break;
+            }
+            case Node::Kind::Aggregate:
+            {
+                auto const& keys = stage->columns;
+                std::vector<cp::Aggregate> aggregates;
+                std::vector<std::string> aggregated;
+                for (auto const& [column, function] : stage->aggregations)
+                {
+                    auto repeated = std::ranges::count_if(
+                        stage->aggregations,
+                        [&](auto const& other) { return other.first == column; });
+                    aggregated.push_back(
+                        repeated > 1 ? column + "_" + function : column);
+                    aggregates.emplace_back(
+                        keys.empty() ? function : "hash_" + function,
+                        nullptr,
+                        cp::FieldRef{ column },
+                        aggregated.back());
+                }
+                if (not keys.empty())
+                {
+                    aggregates.emplace_back(
+                        "hash_min",
+                        nullptr,
+                        cp::FieldRef{ PD_LAZY_ROW },
+                        PD_LAZY_ROW);
+                }
+                std::vector<cp::FieldRef> keyRefs(keys.begin(), keys.end());
+                declarations.emplace_back(
+                    "aggregate",
+                    cp::AggregateNodeOptions{ aggregates, keyRefs });
+
+                // groups have no labels, the keys are moved first and the
+                // first positions ride along
+                names.clear();
+                if (not keys.empty())
+                {
+                    names.push_back(PD_LAZY_ROW);
+                }
+                std::vector<cp::Expression> expressions;
+                std::vector<std::string> outputs;
+                for (auto const& name : keys)
+                {
+                    expressions.push_back(cp::field_ref(name));
+                    outputs.push_back(name);
+                }
+                for (auto const& name : aggregated)
+                {
+                    expressions.push_back(cp::field_ref(name));
+                    outputs.push_back(name);
+                }
+                declarations.push_back(project(expressions, outputs));
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    auto result = ReturnOrThrowOnFailure(cp::DeclarationToTable(
+        cp::Declaration::Sequence(std::move(declarations))));
+
+    auto row = result->schema()->GetFieldIndex(PD_LAZY_ROW);
+    if (row == -1)
+    {
+        return result;
+    }
+    auto indices = ReturnOrThrowOnFailure(cp::SortIndices(*result->column(row)));
+    auto ordered = ReturnOrThrowOnFailure(cp::Take(result, indices)).table();
+    return ReturnOrThrowOnFailure(ordered->RemoveColumn(row));
+}
+
+std::shared_ptr<arrow::Table> execute(NodePtr const& node)
+{
+    switch (node->kind)
+    {
+        case Node::Kind::Scan:
+        {
+            ParquetReadOptions options;
+            options.columns = node->columns;
+            options.filter = node->expression;
+            return withIndex(DataFrame::readParquet(node->path, options));
+        }
+        case Node::Kind::Frame:
+            return withIndex(DataFrame{ node->frame, node->index });
+        case Node::Kind::Slice:
+        {
+            auto table = execute(node->input);
+            auto offset = std::min(node->offset, table->num_rows());
+            return table->Slice(offset, node->length);
+        }
+        case Node::Kind::Sort:
+        {
+            auto table = execute(node->input);
+            std::vector<cp::SortKey> keys;
+            for (auto const& column : node->columns)
+            {
+                keys.emplace_back(
+                    column,
+                    node->ascending ? cp::SortOrder::Ascending :
+                                      cp::SortOrder::Descending);
+            }
+            auto indices = ReturnOrThrowOnFailure(
+                cp::SortIndices(table, cp::SortOptions{ keys }));
+            return ReturnOrThrowOnFailure(cp::Take(table, indices)).table();
+        }
+        case Node::Kind::Select:
+        case Node::Kind::Filter:
+        case Node::Kind::Assign:
+        case Node::Kind::Aggregate:
+            return executeStages(node);
+        default:
+            throw std::logic_error("arithmetic node in a lazy plan");
+    }
+}
+
+void explain(Node const& node, int depth, std::ostringstream& out)
+{
+    out << std::string(2 * depth, ' ');
+    auto list = [](std::vector<std::string> const& names)
+    {
+        std::string text;
+        for (auto const& name : names)
+        {
+            text += (text.empty() ? "" : ", ") + name;
+        }
+        return "[" + text + "]";
+    };
+
+    switch (node.kind)
+    {
+        case Node::Kind::Scan:
+            out << "Scan(" << node.path.string();
+            if (not node.columns.empty())
+            {
+                out << ", columns=" << list(node.columns);
+            }
+            if (node.expression)
+            {
+                out << ", filter=" << node.expression->ToString();
+            }
+            out << ")\n";
+            return;
+        case Node::Kind::Select:
+            out << "Select(" << list(node.columns) << ")\n";
+            break;
+        case Node::Kind::Filter:
+            out << "Filter(" << node.expression->ToString() << ")\n";
+            break;
+        case Node::Kind::Assign:
+            out << "Assign(" << node.name << " = " << node.expression->ToString()
+                << ")\n";
+            break;
+        case Node::Kind::Slice:
+            out << "Slice(" << node.offset << ", " << node.length << ")\n";
+            break;
+        case Node::Kind::Sort:
+            out << "Sort(" << list(node.columns)
+                << (node.ascending ? ", ascending" : ", descending") << ")\n";
+            break;
+        case Node::Kind::Aggregate:
+        {
+            std::vector<std::string> aggregations;
+            for (auto const& [column, function] : node.aggregations)
+            {
+                aggregations.push_back(function + "(" + column + ")");
+            }
+            out << "Aggregate(keys=" << list(node.columns)
+                << ", " << list(aggregations) << ")\n";
+            break;
+        }
+        case Node::Kind::Frame:
+            out << "Frame(" << list(node.frame->schema()->field_names()) << ")\n";
+            return;
+        default:
+            out << "Arithmetic\n";
+            return;
+    }
+    explain(*node.input, depth + 1, out);
+}
+
+}
+
+NodePtr LazyFrame::materialize(NodePtr const& node)
+{
+    if (node->isPlan())
+    {
+        auto df = LazyFrame{ node }.collect();
+        auto frame = std::make_shared<Node>();
+        frame->kind = Node::Kind::Frame;
+        frame->frame = df.array();
+        frame->index = df.indexArray();
+        return frame;
+    }
+    if (node->kind == Node::Kind::Binary)
+    {
+        auto copy = std::make_shared<Node>(*node);
+        copy->lhs = materialize(node->lhs);
+        copy->rhs = materialize(node->rhs);
+        return copy;
+    }
+    return node;
+}
+
+NodePtr LazyFrame::evaluateInputs(NodePtr const& node)
+{
+    if (not node->isPlan())
+    {
+        if (node->kind == Node::Kind::Frame)
+        {
+            return node;
+        }
+        // arithmetic feeding the plan is run by the fused engine first
+        auto df = LazyFrame{ node }.evaluate();
+        auto frame = std::make_shared<Node>();
+        frame->kind = Node::Kind::Frame;
+        frame->frame = df.array();
+        frame->index = df.indexArray();
+        return frame;
+    }
+    if (node->kind == Node::Kind::Scan)
+    {
+        return node;
+    }
+    return withInput(*node, evaluateInputs(node->input));
+}
+
+DataFrame LazyFrame::collect() const
+{
+    if (not m_root->isPlan())
+    {
+        return evaluate();
+    }
+    return toDataFrame(execute(optimize(evaluateInputs(m_root))));
+}
+
+std::string LazyFrame::explain() const
+{
+    std::ostringstream out;
+    pd::explain(*optimize(m_root), 0, out);
+    return out.str();
+}
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include "tbb/parallel_for.h"
+#include "parallel.h"
+#include <functional>
 
 
 struct BinaryOperatorFunctor {
@@ -17,7 +19,7 @@ struct BinaryOperatorFunctor {
 
     void operator()(const tbb::blocked_range<size_t>& range) const {
         for (size_t i = range.begin(); i < range.end(); ++i) {
-            auto res = arrow::compute::CallFunction(func, { lhs[i], rhs[i] });
+            auto res = pd::ParallelCallFunction(func, { lhs[i], rhs[i] });
             if (res.ok()) {
                 result[i] = res.MoveValueUnsafe().array();
             } else {
@@ -27,6 +29,60 @@ struct BinaryOperatorFunctor {
     }
 };
 
+/// func(column i, operand(i)) for every column, in place for the columns
+/// only batch references, the others are replaced by the new array
+inline void CompoundAssign(
+    std::shared_ptr<arrow::RecordBatch>& batch,
+    const char* func,
+    std::function<arrow::Datum(int)> const& operand)
+{
+    auto const& columns = batch->column_data();
+    int N = batch->num_columns();
+
+    // the batch holds each column's data twice, directly and through the
+    // Array it boxes it in. Any other holder shares the buffers
+    std::vector<char> owned(N);
+    for (int i = 0; i < N; ++i) {
+        auto boxed = batch->column(i);
+        owned[i] = batch.use_count() == 1 and boxed.use_count() == 2 and
+            columns[i].use_count() == 2;
+    }
+
+    arrow::ArrayDataVector data(N);
+    tbb::parallel_for(0, N, [&](int i) {
+        std::vector<arrow::Datum> args{ columns[i], operand(i) };
+        if (owned[i] and pd::ReturnOrThrowOnFailure(
+                             pd::CallFunctionInPlace(func, columns[i], args))) {
+            data[i] = columns[i];
+            return;
+        }
+        data[i] = pd::ReturnOrThrowOnFailure(pd::ParallelCallFunction(func, args)).array();
+    });
+
+    // a fresh batch drops the boxed Arrays, which cache buffer pointers, and
+    // takes the types of replaced columns
+    arrow::FieldVector fields(N);
+    for (int i = 0; i < N; ++i) {
+        fields[i] = batch->schema()->field(i)->WithType(data[i]->type);
+    }
+    batch = arrow::RecordBatch::Make(
+        arrow::schema(fields, batch->schema()->metadata()), batch->num_rows(), data);
+}
+
+#define COMPOUND_OPERATOR_PARALLEL(sign, func) \
+    DataFrame& DataFrame::operator sign##=(DataFrame const &other) { \
+        CompoundAssign(m_array, #func, [&](int i) { return arrow::Datum{ other.m_array->column_data(i) }; }); \
+        return *this; \
+    } \
+    DataFrame& DataFrame::operator sign##=(Series const &other) { \
+        CompoundAssign(m_array, #func, [&](int) { return arrow::Datum{ other.value() }; }); \
+        return *this; \
+    } \
+    DataFrame& DataFrame::operator sign##=(Scalar const &other) { \
+        CompoundAssign(m_array, #func, [&](int) { return arrow::Datum{ other.value() }; }); \
+        return *this; \
+    }
+
 #define BINARY_OPERATOR_PARALLEL_DF(sign, func)                                                        \
     DataFrame DataFrame::operator sign(DataFrame const &other) const {                                  \
         std::vector<std::shared_ptr<arrow::ArrayData>> df_result(m_array->num_columns());               \
@@ -39,12 +95,11 @@ struct BinaryOperatorFunctor {
 
 #define BINARY_OPERATOR_PARALLEL_SCALAR_OR_SERIES(T, sign, func)                                                                                                      \
     DataFrame DataFrame::operator sign(T const &other) const { \
-        std::vector<std::shared_ptr<arrow::ArrayData>> df_result; \
-        df_result.reserve(m_array->num_columns()); \
+        std::vector<std::shared_ptr<arrow::ArrayData>> df_result(m_array->num_columns()); \
         tbb::parallel_for(tbb::blocked_range<size_t>(0, m_array->num_columns()), [&](const tbb::blocked_range<size_t> &r) { \
             for (size_t i = r.begin(); i < r.end(); ++i) { \
                 auto col = m_array->column(i); \
-                auto result = arrow::compute::CallFunction(#func, {col, other.value()}); \
+                auto result = pd::ParallelCallFunction(#func, {col, other.value()}); \
                 if (result.ok()) { \
                     df_result[i] = result.MoveValueUnsafe().array(); \
                 } else { \
@@ -62,167 +117,17 @@ BINARY_OPERATOR_PARALLEL_DF(sign, func) \
 BINARY_OPERATOR_PARALLEL_SCALAR_OR_SERIES(Series, sign, func) \
 BINARY_OPERATOR_PARALLEL_SCALAR_OR_SERIES(Scalar, sign, func)
 
-#define GROUPBY_NUMERIC_AGG(func, T) \
+#define GROUPBY_HASH_AGG(func) \
 arrow::Result<pd::DataFrame> GroupBy:: func(std::vector<std::string> const& args) \
 { \
-        auto schema = df.m_array->schema(); \
-        auto N = groups.size(); \
-    \
-    auto fv = fieldVectors(args, schema); \
-        arrow::ArrayDataVector arr(args.size()); \
-    \
-                for (size_t i = 0; i < args.size(); ++i) \
-                { \
-                    const auto& arg = args[i]; \
-                    long L = uniqueKeys->length(); \
-                    int index = schema->GetFieldIndex(arg); \
-    \
-                    std::vector<T> result(L); \
-                    tbb::parallel_for( \
-                        tbb::blocked_range<size_t>(0, uniqueKeys->length()), \
-                        [&](const tbb::blocked_range<size_t>& r) \
-                        { \
-                            for (size_t j = 0; j < L; j++) \
-                            { \
-                                auto key = uniqueKeys->GetScalar(long(j)).MoveValueUnsafe(); \
-                                auto& group = groups.at(key); \
-    \
-    arrow::Datum d = arrow::compute::CallFunction( \
-                                                     #func,\
-                                                     { group[index] }, \
-                                                     defaultOpt.get()) \
-                                                     .MoveValueUnsafe(); \
-                                result[j] = \
-        d.scalar_as<arrow::CTypeTraits<T>::ScalarType>().value; \
-                            } \
-                        }); \
-    \
-                    auto builder = arrow::CTypeTraits<T>::BuilderType(); \
-                        builder.AppendValues(result); \
-    \
-                    std::shared_ptr<arrow::ArrayData> data; \
-                        builder.FinishInternal(&data); \
-                    arr[i] = data; \
-                } \
-    \
-        return pd::DataFrame(arrow::schema(fv), long(N), arr); \
+    ARROW_ASSIGN_OR_RAISE(auto columns, hashAggregate(#func, args)); \
+    return makeFrame(args, columns); \
 } \
 \
 arrow::Result<pd::Series> GroupBy:: func(std::string const& arg) \
 { \
-    auto schema = df.m_array->schema(); \
-    auto N = groups.size(); \
-\
-auto fv = schema->GetFieldByName(arg); \
-\
-    long L = uniqueKeys->length(); \
-    int index = schema->GetFieldIndex(arg); \
-\
-std::vector<T> result(L); \
-    tbb::parallel_for( \
-        tbb::blocked_range<size_t>(0, L), \
-        [&](const tbb::blocked_range<size_t>& r) \
-        { \
-            for (size_t j = r.begin(); j != r.end(); ++j) \
-            { \
-                auto key = \
-                        uniqueKeys->GetScalar(long(j)).MoveValueUnsafe(); \
-                auto& group = groups.at(key); \
-\
-                arrow::Datum d = arrow::compute::CallFunction( \
-                                     #func, \
-                                     { group[index] }, \
-                                     defaultOpt.get()) \
-                                     .MoveValueUnsafe(); \
-                result[j] = d.scalar_as<arrow::CTypeTraits<T>::ScalarType>().value; \
-            } \
-        }); \
-\
-    auto builder = arrow::CTypeTraits<T>::BuilderType(); \
-    builder.AppendValues(result); \
-\
-std::shared_ptr<arrow::Array> data; \
-builder.Finish(&data); \
-\
-return pd::Series(data, nullptr); \
-}
-
-#define GROUPBY_AGG(func) \
-arrow::Result<pd::DataFrame> GroupBy:: func(std::vector<std::string> const& args) \
-{ \
-                auto schema = df.m_array->schema(); \
-                auto num_groups = groups.size(); \
-                auto fv = fieldVectors(args, schema); \
-                arrow::ArrayDataVector arr(args.size()); \
-            for (size_t i = 0; i < args.size(); i++)\
-                                    { \
-    const auto& arg = args[i]; \
-    long L = uniqueKeys->length(); \
-    int index = schema->GetFieldIndex(arg); \
-    \
-    arrow::ScalarVector result(L); \
-    tbb::parallel_for( \
-    tbb::blocked_range<size_t>(0, L), \
-    [&](const tbb::blocked_range<size_t>& r) \
-    { \
-    for (size_t j = r.begin(); j != r.end(); ++j) \
-    { \
-    auto key = uniqueKeys->GetScalar(long(j)).MoveValueUnsafe(); \
-    auto& group = groups.at(key); \
-    arrow::Datum d = pd::ReturnOrThrowOnFailure(arrow::compute::CallFunction( \
-                     #func,\
-                     { group[index] }, \
-                     defaultOpt.get())); \
-    result[j] = d.scalar();\
-    }\
-    });\
-    \
-    ARROW_ASSIGN_OR_RAISE(arr[i], buildData(result));\
-    }\
-        \
-        return pd::DataFrame(arrow::schema(fv), long(num_groups), arr);\
-}\
-\
-arrow::Result<pd::Series> GroupBy:: func(std::string const& arg) \
-{ \
-            auto schema = df.m_array->schema(); \
-            auto N = groups.size(); \
-        \
-        auto fv = schema->GetFieldByName(arg); \
-        \
-            long L = uniqueKeys->length(); \
-            int index = schema->GetFieldIndex(arg); \
-        \
-        arrow::ScalarVector result(L); \
-            tbb::parallel_for( \
-                tbb::blocked_range<size_t>(0, L), \
-                [&](const tbb::blocked_range<size_t>& r) \
-                { \
-                    for (size_t j = r.begin(); j != r.end(); ++j) \
-                    { \
-                        auto key = \
-                        uniqueKeys->GetScalar(long(j)).MoveValueUnsafe(); \
-                        auto& group = groups.at(key); \
-        \
-                        arrow::Datum d = arrow::compute::CallFunction( \
-                                             #func, \
-                                             { group[index] }, \
-                                             defaultOpt.get()) \
-                                             .MoveValueUnsafe(); \
-                        result[j] = d.scalar(); \
-                    } \
-                }); \
-        \
-std::shared_ptr<arrow::ArrayBuilder> builder;\
-        if(not result.empty())\
-        {\
-        builder = arrow::MakeBuilder(result.back()->type).MoveValueUnsafe();\
-        RETURN_NOT_OK(builder->AppendScalars(result));\
-        }\
-        std::shared_ptr<arrow::Array> data; \
-        RETURN_NOT_OK(builder->Finish(&data)); \
-        \
-        return pd::Series(data, nullptr); \
+    ARROW_ASSIGN_OR_RAISE(auto columns, hashAggregate(#func, { arg })); \
+    return pd::Series(columns.front(), uniqueKeys, arg); \
 }
 
 
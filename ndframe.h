@@ -5,6 +5,7 @@
 #include <arrow/compute/api_scalar.h>
 #include <arrow/api.h>
 #include <arrow/scalar.h>
+#include "indexer.h"
 #include "scalar.h"
 #include "sstream"
 #include <cmath>
@@ -13,38 +14,6 @@
 
 namespace pd {
 
-struct HashScalar{
-
-    bool operator()(std::shared_ptr<arrow::Scalar> const& a,
-                    std::shared_ptr<arrow::Scalar> const& b) const
-    {
-        return a->Equals(
-            b->CastTo(a->type).MoveValueUnsafe());
-    }
-
-    bool equal(std::shared_ptr<arrow::Scalar> const& a,
-                    std::shared_ptr<arrow::Scalar> const& b) const
-    {
-        return a->Equals(
-            b->CastTo(a->type).MoveValueUnsafe());
-    }
-
-    size_t operator()(std::shared_ptr<arrow::Scalar> const& scalar) const
-    {
-        return scalar->hash();
-    }
-
-    size_t hash(std::shared_ptr<arrow::Scalar> const& scalar) const
-    {
-        return scalar->hash();
-    }
-};
-
-using Indexer = std::unordered_map<std::shared_ptr<arrow::Scalar>,
-                                   int64_t,
-                                   HashScalar,
-                                   HashScalar>;
-
 /// Thrown when an invalid cast is attempted on the array data.
 struct RawArrayCastException : std::exception
 {
@@ -204,12 +173,7 @@ std::vector<uint8_t> NDFrame<BaseT>::makeValidFlags(
 template<class BaseT>
 std::shared_ptr<arrow::Array> NDFrame<BaseT>::uint_range(int64_t n_rows)
 {
-    std::vector<uint64_t> index(n_rows);
-    std::iota(index.begin(), index.end(), 0);
-    arrow::UInt64Builder builder;
-
-    ThrowOnFailure(builder.AppendValues(index));
-    return ReturnOrThrowOnFailure(builder.Finish());
+    return RangeIndex{ 0, static_cast<uint64_t>(n_rows) }.array();
 }
 
 template<class BaseT>
@@ -218,10 +182,7 @@ void NDFrame<BaseT>::setIndexer()
     if(m_array != nullptr)
     {
         isIndex = true;
-        for (int i = 0; i < m_array->length(); i++)
-        {
-            indexer[m_array->GetScalar(i).MoveValueUnsafe()] = i;
-        }
+        indexer = Indexer(m_array);
     }
 }
 
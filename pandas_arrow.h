@@ -6,6 +6,11 @@
 
 #include "core.h"
 #include "concat.h"
+#include "io.h"
+#include "chunked.h"
+#include "lazy.h"
+#include "parallel.h"
+#include "eval.h"
 #include "resample.h"
 #include "group_by.h"
 #include "stringlike.h"
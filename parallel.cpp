@@ -0,0 +1,306 @@
+//
+// Created by dewe on 10/17/26.
+//
+#include "parallel.h"
+#include <arrow/compute/kernel.h>
+#include <arrow/compute/registry.h>
+#include <arrow/util/bit_util.h>
+#include <arrow/util/bitmap_ops.h>
+#include <algorithm>
+#include <mutex>
+#include <tbb/parallel_for.h>
+
+
+namespace pd {
+
+using namespace arrow::compute;
+
+/// the ScalarKernel that CallFunction would pick, or nullptr when the call
+/// cannot be run morsel by morsel
+static arrow::Result<ScalarKernel const*> morselKernel(
+    Function const& function,
+    std::vector<arrow::TypeHolder> const& types)
+{
+    if (function.kind() != Function::SCALAR)
+    {
+        return nullptr;
+    }
+
+    auto dispatched = types;
+    ARROW_ASSIGN_OR_RAISE(auto kernel, function.DispatchBest(&dispatched));
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        if (not dispatched[i].type->Equals(*types[i].type))
+        {
+            // implicit casts, leave them to the regular executor
+            return nullptr;
+        }
+    }
+
+    auto scalarKernel = static_cast<ScalarKernel const*>(kernel);
+    if (scalarKernel->mem_allocation != MemAllocation::PREALLOCATE or
+        not scalarKernel->can_write_into_slices or
+        (scalarKernel->null_handling != NullHandling::INTERSECTION and
+         scalarKernel->null_handling != NullHandling::OUTPUT_NOT_NULL))
+    {
+        return nullptr;
+    }
+    return scalarKernel;
+}
+
+/// output validity of rows [begin, begin + length), the AND of the inputs.
+/// An input sharing the output bitmap is already in place
+static void intersectValidity(
+    std::vector<arrow::Datum> const& args,
+    int64_t begin,
+    int64_t length,
+    arrow::ArrayData& out)
+{
+    auto const& outBitmap = out.buffers[0];
+    auto bitmap = outBitmap->mutable_data();
+    auto sharesBitmap = [&](arrow::Datum const& arg)
+    { return arg.is_array() and arg.array()->buffers[0] == outBitmap; };
+
+    bool first = std::ranges::none_of(args, sharesBitmap);
+    for (auto const& arg : args)
+    {
+        if (not arg.is_array() or sharesBitmap(arg) or arg.null_count() == 0)
+        {
+            continue;
+        }
+
+        auto const& data = *arg.array();
+        auto bits = data.buffers[0]->data();
+        if (first)
+        {
+            arrow::internal::CopyBitmap(
+                bits, data.offset + begin, length, bitmap, begin);
+            first = false;
+        }
+        else
+        {
+            arrow::internal::BitmapAnd(
+                bitmap,
+                begin,
+                bits,
+                data.offset + begin,
+                length,
+                begin,
+                bitmap);
+        }
+    }
+}
+
+namespace {
+
+/// a call that can run morsel by morsel, kernel is nullptr when it cannot
+struct MorselCall
+{
+    ScalarKernel const* kernel{ nullptr };
+    std::unique_ptr<KernelState> state;
+    std::shared_ptr<arrow::DataType> outType;
+    int64_t length{ -1 };
+    bool nullable{ false };
+};
+
+}
+
+static arrow::Result<MorselCall> prepare(
+    ExecContext* context,
+    std::string const& name,
+    std::vector<arrow::Datum> const& args,
+    FunctionOptions const* options)
+{
+    MorselCall call;
+    std::vector<arrow::TypeHolder> types;
+    for (auto const& arg : args)
+    {
+        if (arg.is_array() and (call.length == -1 or arg.length() == call.length))
+        {
+            call.length = arg.length();
+            call.nullable |= arg.null_count() > 0;
+        }
+        else if (not arg.is_scalar() or not arg.scalar()->is_valid)
+        {
+            return call;
+        }
+        types.emplace_back(arg.type());
+    }
+    if (call.length == -1)
+    {
+        return call;
+    }
+
+    ARROW_ASSIGN_OR_RAISE(auto function, GetFunctionRegistry()->GetFunction(name));
+    ARROW_ASSIGN_OR_RAISE(auto kernel, morselKernel(*function, types));
+    if (kernel == nullptr)
+    {
+        return call;
+    }
+
+    if (options == nullptr)
+    {
+        options = function->default_options();
+    }
+
+    KernelContext initContext(context, kernel);
+    if (kernel->init)
+    {
+        ARROW_ASSIGN_OR_RAISE(
+            call.state,
+            kernel->init(&initContext, KernelInitArgs{ kernel, types, options }));
+    }
+
+    ARROW_ASSIGN_OR_RAISE(
+        auto outType,
+        kernel->signature->out_type().Resolve(&initContext, types));
+    if (dynamic_cast<arrow::FixedWidthType const*>(outType.type) == nullptr)
+    {
+        return call;
+    }
+    call.outType = outType.GetSharedPtr();
+    call.kernel = kernel;
+    return call;
+}
+
+/// runs call over the morsels of args in parallel, each writing its slice of
+/// out. out starts at offset 0 and has a validity bitmap if the result can
+/// hold nulls
+static arrow::Status execMorsels(
+    ExecContext* context,
+    MorselCall const& call,
+    std::vector<arrow::Datum> const& args,
+    arrow::ArrayData& out)
+{
+    ExecBatch batch(args, call.length);
+    std::mutex errorMutex;
+    arrow::Status status;
+
+    auto numMorsels = (call.length + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE;
+    tbb::parallel_for(
+        int64_t{ 0 },
+        numMorsels,
+        [&](int64_t morsel)
+        {
+            auto begin = morsel * PD_MORSEL_SIZE;
+            auto n = std::min(PD_MORSEL_SIZE, call.length - begin);
+
+            ExecSpan span(batch);
+            span.length = n;
+            for (auto& value : span.values)
+            {
+                if (value.is_array())
+                {
+                    value.array.SetSlice(value.array.offset + begin, n);
+                }
+            }
+
+            if (out.buffers[0])
+            {
+                intersectValidity(args, begin, n, out);
+            }
+
+            arrow::ArraySpan outSpan(out);
+            outSpan.SetSlice(begin, n);
+            ExecResult result;
+            result.value = std::move(outSpan);
+
+            KernelContext kernelContext(context, call.kernel);
+            kernelContext.SetState(call.state.get());
+            auto morselStatus = call.kernel->exec(&kernelContext, span, &result);
+            if (not morselStatus.ok())
+            {
+                std::lock_guard lock(errorMutex);
+                status = std::move(morselStatus);
+            }
+        });
+
+    return status;
+}
+
+arrow::Result<arrow::Datum> ParallelCallFunction(
+    std::string const& name,
+    std::vector<arrow::Datum> const& args,
+    FunctionOptions const* options)
+{
+    ExecContext context;
+    ARROW_ASSIGN_OR_RAISE(auto call, prepare(&context, name, args, options));
+    if (call.kernel == nullptr or call.length < 2 * PD_MORSEL_SIZE)
+    {
+        return CallFunction(name, args, options);
+    }
+
+    auto bitWidth =
+        static_cast<arrow::FixedWidthType const&>(*call.outType).bit_width();
+    std::shared_ptr<arrow::Buffer> values, bitmap;
+    ARROW_ASSIGN_OR_RAISE(
+        values,
+        arrow::AllocateBuffer(arrow::bit_util::BytesForBits(call.length * bitWidth)));
+    if (call.nullable and call.kernel->null_handling == NullHandling::INTERSECTION)
+    {
+        ARROW_ASSIGN_OR_RAISE(bitmap, arrow::AllocateBitmap(call.length));
+    }
+    auto out = arrow::ArrayData::Make(
+        call.outType,
+        call.length,
+        { bitmap, values },
+        bitmap ? arrow::kUnknownNullCount : 0);
+
+    ARROW_RETURN_NOT_OK(execMorsels(&context, call, args, *out));
+    return arrow::Datum{ out };
+}
+
+/// target owns its buffers alone and they are writable from its first row
+static bool writable(arrow::ArrayData const& target)
+{
+    if (target.offset != 0 or not target.child_data.empty() or target.dictionary)
+    {
+        return false;
+    }
+    return std::ranges::all_of(
+        target.buffers,
+        [](std::shared_ptr<arrow::Buffer> const& buffer)
+        {
+            return buffer == nullptr or
+                (buffer.use_count() == 1 and buffer->is_mutable() and
+                 buffer->parent() == nullptr);
+        });
+}
+
+arrow::Result<bool> CallFunctionInPlace(
+    std::string const& name,
+    std::shared_ptr<arrow::ArrayData> const& target,
+    std::vector<arrow::Datum> const& args,
+    FunctionOptions const* options)
+{
+    if (not writable(*target))
+    {
+        return false;
+    }
+
+    ExecContext context;
+    ARROW_ASSIGN_OR_RAISE(auto call, prepare(&context, name, args, options));
+    if (call.kernel == nullptr or call.length != target->length or
+        not call.outType->Equals(*target->type))
+    {
+        return false;
+    }
+
+    if (call.kernel->null_handling == NullHandling::OUTPUT_NOT_NULL)
+    {
+        target->buffers[0] = nullptr;
+    }
+    else if (call.nullable and target->buffers[0] == nullptr)
+    {
+        // all valid, the inputs' nulls are ANDed in morsel by morsel
+        ARROW_ASSIGN_OR_RAISE(target->buffers[0], arrow::AllocateBitmap(call.length));
+        arrow::bit_util::SetBitsTo(
+            target->buffers[0]->mutable_data(), 0, call.length, true);
+    }
+
+    ARROW_RETURN_NOT_OK(execMorsels(&context, call, args, *target));
+    target->null_count = target->buffers[0] ? arrow::kUnknownNullCount : 0;
+    return true;
+}
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+//
+// Created by dewe on 10/17/26.
+//
+#include <algorithm>
+#include <arrow/api.h>
+#include <arrow/compute/api.h>
+#include <memory>
+#include <tbb/parallel_for.h>
+#include <vector>
+
+
+namespace pd {
+
+/// rows per morsel of ParallelCallFunction, a multiple of 64 so every morsel
+/// starts on a whole byte of a validity bitmap and fits in L2
+constexpr int64_t PD_MORSEL_SIZE = { 1 << 16 };
+
+/// the rows [0, length) counting sorted by partition with a single scatter.
+/// Every morsel of PD_MORSEL_SIZE rows counts its rows per partition on tbb,
+/// the counts become partition major cursors and every morsel writes its
+/// rows through them, so the rows of a partition stay ascending.
+/// partitionOf(row) returns the partition of a row in [0, numPartitions), or
+/// -1 to leave it out, and is called twice per row. offsets receives
+/// numPartitions + 1 entries, partition p is rows[offsets[p], offsets[p + 1])
+template<class RowT, class PartitionFn>
+std::unique_ptr<RowT[]> scatterByPartition(
+    int64_t length,
+    int64_t numPartitions,
+    PartitionFn const& partitionOf,
+    std::vector<int64_t>& offsets)
+{
+    auto numMorsels = (length + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE;
+    std::vector<int64_t> cursors(numMorsels * numPartitions, 0);
+    tbb::parallel_for(
+        int64_t{ 0 },
+        numMorsels,
+        [&](int64_t morsel)
+        {
+            auto counts = cursors.data() + morsel * numPartitions;
+            auto end = std::min(length, (morsel + 1) * PD_MORSEL_SIZE);
+            for (auto row = morsel * PD_MORSEL_SIZE; row < end; ++row)
+            {
+                if (int64_t p = partitionOf(row); p >= 0)
+                {
+                    ++counts[p];
+                }
+            }
+        });
+
+    offsets.assign(numPartitions + 1, 0);
+    int64_t offset = 0;
+    for (int64_t p = 0; p < numPartitions; ++p)
+    {
+        offsets[p] = offset;
+        for (int64_t morsel = 0; morsel < numMorsels; ++morsel)
+        {
+            auto& cursor = cursors[morsel * numPartitions + p];
+            auto count = cursor;
+            cursor = offset;
+            offset += count;
+        }
+    }
+    offsets[numPartitions] = offset;
+
+    std::unique_ptr<RowT[]> rows(new RowT[offset]);
+    tbb::parallel_for(
+        int64_t{ 0 },
+        numMorsels,
+        [&](int64_t morsel)
+        {
+            auto cursor = cursors.data() + morsel * numPartitions;
+            auto end = std::min(length, (morsel + 1) * PD_MORSEL_SIZE);
+            for (auto row = morsel * PD_MORSEL_SIZE; row < end; ++row)
+            {
+                if (int64_t p = partitionOf(row); p >= 0)
+                {
+                    rows[cursor[p]++] = static_cast<RowT>(row);
+                }
+            }
+        });
+    return rows;
+}
+
+/// arrow::compute::CallFunction for element-wise functions, split into
+/// morsels of PD_MORSEL_SIZE rows that run in parallel on tbb. Each morsel
+/// is a zero-copy slice of the inputs and the kernel writes straight into
+/// its part of one preallocated output, so the pieces are never
+/// concatenated. Short inputs, non-scalar functions, chunked inputs,
+/// kernels that cannot write into slices and calls needing implicit casts
+/// go through CallFunction unchanged.
+arrow::Result<arrow::Datum> ParallelCallFunction(
+    std::string const& function,
+    std::vector<arrow::Datum> const& args,
+    arrow::compute::FunctionOptions const* options = nullptr);
+
+/// ParallelCallFunction writing the result over target instead of a new
+/// array, for the compound assignment operators. The caller must hold the
+/// only reference to target, which is normally one of args (aliasing is
+/// fine, every row only reads its own inputs). Returns false without
+/// touching target when its buffers are shared, read-only or sliced, or
+/// when the result would not have target's type and length; the caller then
+/// copies on write through ParallelCallFunction.
+arrow::Result<bool> CallFunctionInPlace(
+    std::string const& function,
+    std::shared_ptr<arrow::ArrayData> const& target,
+    std::vector<arrow::Datum> const& args,
+    arrow::compute::FunctionOptions const* options = nullptr);
+
+}
@@ -6,7 +6,11 @@
 #include <arrow/compute/api.h>
 #include <arrow/compute/exec/aggregate.h>
 #include <arrow/io/api.h>
+#include <arrow/util/bit_util.h>
+#include <atomic>
+#include <cstring>
 #include <tabulate/table.hpp>
+#include <tbb/parallel_for.h>
 #include <unordered_set>
 #include "arrow/compute/kernels/autocorr.h"
 #include "arrow/compute/kernels/corr.h"
@@ -15,6 +19,7 @@
 #include "arrow/compute/kernels/pct_change.h"
 #include "datetimelike.h"
 #include "filesystem"
+#include "parallel.h"
 #include "resample.h"
 #include "ranges"
 #include "stringlike.h"
@@ -22,15 +27,24 @@
 
 #define BINARY_OPERATOR(sign, name) \
 Series Series:: operator sign (const Series &a) const { \
-    return ReturnSeriesOrThrowOnError(arrow::compute::CallFunction(#name, {m_array, a.m_array})); \
+    return ReturnSeriesOrThrowOnError(ParallelCallFunction(#name, {m_array, a.m_array})); \
 }                     \
 \
 Series Series:: operator sign (const Scalar &a) const{ \
-    return ReturnSeriesOrThrowOnError(arrow::compute::CallFunction(#name, {m_array, a.scalar})); \
+    return ReturnSeriesOrThrowOnError(ParallelCallFunction(#name, {m_array, a.scalar})); \
 }                     \
 \
 Series operator sign (Scalar const& a, Series const& b) { \
-  return ReturnSeriesOrThrowOnError(arrow::compute::CallFunction(#name, {a.value(), b.m_array})); \
+  return ReturnSeriesOrThrowOnError(ParallelCallFunction(#name, {a.value(), b.m_array})); \
+}
+
+#define COMPOUND_OPERATOR(sign, name) \
+Series& Series:: operator sign##= (const Series &a) { \
+    return compoundAssign(#name, a.m_array); \
+}                     \
+\
+Series& Series:: operator sign##= (const Scalar &a) { \
+    return compoundAssign(#name, a.scalar); \
 }
 
 #define GenericFunction(name, ReturnFilter, OutT, ClassT) \
@@ -189,6 +203,32 @@ namespace pd
     BINARY_OPERATOR(&&, and)
     BINARY_OPERATOR(||, or)
 
+    COMPOUND_OPERATOR(+, add)
+    COMPOUND_OPERATOR(-, subtract)
+    COMPOUND_OPERATOR(*, multiply)
+    COMPOUND_OPERATOR(/, divide)
+
+    Series& Series::compoundAssign(std::string const& function,
+                                   arrow::Datum const& other)
+    {
+        // nothing else can observe an array and data only this Series holds
+        if (m_array.use_count() == 1 and m_array->data().use_count() == 1)
+        {
+            auto data = m_array->data();
+            if (ReturnOrThrowOnFailure(
+                    CallFunctionInPlace(function, data, { data, other })))
+            {
+                // the Array caches the buffer pointers, a bitmap may be new
+                m_array = arrow::MakeArray(data);
+                return *this;
+            }
+        }
+        m_array = ReturnOrThrowOnFailure(
+                      ParallelCallFunction(function, { m_array, other }))
+                      .make_array();
+        return *this;
+    }
+
     Series Series::operator-()  const{
         return ReturnSeriesOrThrowOnError(arrow::compute::Negate(
             m_array,
@@ -275,13 +315,7 @@ namespace pd
     {
         if (isIndex)
         {
-            try{
-                return indexer.at(search.scalar);
-            }
-            catch (std::out_of_range const& )
-            {
-                return -1;
-            }
+            return indexer.find(*search.scalar);
         }
         else
         {
@@ -825,16 +859,16 @@ namespace pd
         }
 
         arrow::Int64Builder intersection_indices;
+        auto inOther = other.indexer.find(*m_array);
         std::vector<int64_t> result;
         result.reserve(indexer.size());
-        for (auto const& [index, value] : indexer)
+        for (int64_t position : indexer.positions())
         {
-            if (other.indexer.count(index) == 1)
+            if (inOther[position] != -1)
             {
-                result.push_back(value);
+                result.push_back(position);
             }
         }
-        std::sort(result.begin(), result.end());
         ThrowOnFailure(intersection_indices.AppendValues(result));
 
         auto intersection_array = ReturnOrThrowOnFailure(arrow::compute::Take(
@@ -885,8 +919,12 @@ namespace pd
         if (!isIndex) {
             throw std::runtime_error("Cannot get indexed values from non-index series");
         }
-        auto key_view = indexer | std::views::keys;
-        return {key_view.begin(), key_view.end()};
+        std::vector<std::shared_ptr<arrow::Scalar>> keys;
+        for (int64_t position : indexer.positions())
+        {
+            keys.push_back(m_array->GetScalar(position).ValueUnsafe());
+        }
+        return keys;
     }
 
     Series Series::append(const Series &to_append,
@@ -927,18 +965,9 @@ namespace pd
 
             if (isIndex)
             {
-                Indexer new_indexer;
-                int i = 0;
-                for(i = 0; i < concatenated_arrays->length(); i++)
-                {
-                    new_indexer[concatenated_arrays->GetScalar(i)
-                                    .MoveValueUnsafe()] = i;
-                }
-
                 auto new_series =
                     Series(concatenated_arrays, nullptr, m_name, true);
-                new_series.indexer = new_indexer;
-                new_series.isIndex = true;
+                new_series.setIndexer();
 
                 return new_series;
             }
@@ -1323,118 +1352,81 @@ namespace pd
     {
         return if_else(cond, other);
     }
-    pd::Series Series::reindex(const shared_ptr<arrow::Array>& newIndex,
-                               std::optional< std::unordered_map<int64_t, int64_t>>  indexer) const noexcept
+    pd::Series Series::reindex(const shared_ptr<arrow::Array>& newIndex) const
     {
-        if (newIndex->type()->id() != m_index->type()->id())
-        {
-            throw std::runtime_error(
-                "Index type of newIndex does not match "
-                "the index type of the current series.");
-        }
-
-
-        auto new_idx_int = pd::ReturnOrThrowOnFailure(arrow::compute::Cast(newIndex, {arrow::int64()})).array_as<arrow::Int64Array>();
-        // Get the length of the new index
-        int64_t newIndexLen = newIndex->length();
-
-        // Create a new values array builder for the reindexed series
-        // Build the new values array
-        auto newValuesBuilder = ReturnOrThrowOnFailure(
-            arrow::MakeBuilder(m_array->type()));
-        newValuesBuilder->Reserve(newIndexLen);
-
-        // Create a hashmap to store the index-value pairs of the current series
-        if(not indexer)
-        {
-            indexer =  std::unordered_map<int64_t, int64_t>{};
-            auto idx_int = pd::ReturnOrThrowOnFailure(arrow::compute::Cast(m_index, {arrow::int64()})).array_as<arrow::Int64Array>();
-            for (int i = 0; i < m_index->length(); i++)
-            {
-                indexer->insert_or_assign(idx_int->Value(i), i);
-            }
-        }
-
-        // Iterate through the new index and add the corresponding values to the new values array builder
-        for (int64_t i = 0; i < newIndexLen; i++)
-        {
-            auto && newIndexValue = new_idx_int->Value(i);
-            if (indexer->count(newIndexValue) == 1)
-            {
-                int64_t valueIndex = (*indexer)[newIndexValue];
-                newValuesBuilder->AppendScalar(*m_array->GetScalar(valueIndex).MoveValueUnsafe());
-            }
-            else{
-                newValuesBuilder->AppendNull();
-            }
-        }
-
-        std::shared_ptr<arrow::Array> newValues;
-        ThrowOnFailure(newValuesBuilder->Finish(&newValues));
+        // one take over the values, labels missing from m_index become nulls
+        auto takeIndices = Indexer(m_index).takeIndices(*newIndex);
+        auto newValues = ReturnOrThrowOnFailure(
+            arrow::compute::Take(*m_array, *takeIndices));
 
         // Return a new series with the reindexed values and new index
         return { newValues, newIndex, m_name };
     }
 
-    pd::Series Series::reindexAsync(std::shared_ptr<arrow::Array> const&newIndex,
-                                    std::optional< std::unordered_map<int64_t, int64_t>>  indexer) const noexcept
+    pd::Series Series::reindexAsync(std::shared_ptr<arrow::Array> const&newIndex) const
     {
-        if (newIndex->type()->id() != m_index->type()->id())
+        // the Indexer builds and probes large indexes in parallel. Values of
+        // a fixed byte width are then gathered by morsels straight into one
+        // output buffer, anything else goes through a single Take
+        auto takeIndices = Indexer(m_index).takeIndices(*newIndex);
+        auto const& type = *m_array->type();
+        auto length = takeIndices->length();
+        if (length <= PD_MORSEL_SIZE or type.id() == arrow::Type::BOOL or
+            not arrow::is_primitive(type.id()))
         {
-            throw std::runtime_error(
-                "Index type of newIndex does not match "
-                "the index type of the current series.");
-        }
-
-        // Get the length of the new index
-        int64_t newIndexLen = newIndex->length();
-        auto new_idx_int =
-            pd::ReturnOrThrowOnFailure(
-                arrow::compute::Cast(newIndex, { arrow::int64() }))
-                .array_as<arrow::Int64Array>();
-        // Create a new values array builder for the reindexed series
-        // Use Intel TBB to parallelize the reindex operation
-        auto null = arrow::MakeNullScalar(m_array->type());
-        std::vector<ScalarPtr> scalars(newIndexLen, null);
-
-        // Create a hashmap to store the index-value pairs of the current series
-        if (not indexer)
-        {
-            indexer = std::unordered_map<int64_t, int64_t>{};
-            auto idx_int =
-                pd::ReturnOrThrowOnFailure(
-                    arrow::compute::Cast(m_index, { arrow::int64() }))
-                    .array_as<arrow::Int64Array>();
-            for (int i = 0; i < m_index->length(); i++)
-            {
-                indexer->insert_or_assign(idx_int->Value(i), i);
-            }
+            return { ReturnOrThrowOnFailure(
+                         arrow::compute::Take(*m_array, *takeIndices)),
+                     newIndex,
+                     m_name };
         }
 
+        auto width = static_cast<arrow::FixedWidthType const&>(type).bit_width() / 8;
+        std::shared_ptr<arrow::Buffer> values =
+            ReturnOrThrowOnFailure(arrow::AllocateBuffer(length * width));
+        auto bitmap = ReturnOrThrowOnFailure(arrow::AllocateBitmap(length));
+        auto source = m_array->data()->GetValues<uint8_t>(1, 0) +
+            m_array->offset() * width;
+        auto target = values->mutable_data();
+        auto bits = bitmap->mutable_data();
+        auto positions = takeIndices->raw_values();
+
+        // every morsel starts on a whole byte of the bitmap
+        std::atomic<int64_t> nullCount{ 0 };
+        auto numMorsels = (length + PD_MORSEL_SIZE - 1) / PD_MORSEL_SIZE;
         tbb::parallel_for(
-            0L,
-            newIndexLen,
-            [&](int64_t i)
+            int64_t{ 0 },
+            numMorsels,
+            [&](int64_t morsel)
             {
-                auto&& newIndexValue = new_idx_int->Value(i);
-                if (indexer->count(newIndexValue) == 1)
+                int64_t nulls = 0;
+                auto end = std::min(length, (morsel + 1) * PD_MORSEL_SIZE);
+                for (auto i = morsel * PD_MORSEL_SIZE; i < end; ++i)
                 {
-                    int64_t valueIndex = indexer->at(newIndexValue);
-                    scalars[i] =
-                        m_array->GetScalar(valueIndex).MoveValueUnsafe();
+                    bool valid = takeIndices->IsValid(i) and
+                        m_array->IsValid(positions[i]);
+                    arrow::bit_util::SetBitTo(bits, i, valid);
+                    if (valid)
+                    {
+                        std::memcpy(
+                            target + i * width, source + positions[i] * width, width);
+                    }
+                    else
+                    {
+                        std::memset(target + i * width, 0, width);
+                        ++nulls;
+                    }
                 }
+                nullCount += nulls;
             });
-        // Build the new values array
-        auto newValuesBuilder =
-            pd::ReturnOrThrowOnFailure(arrow::MakeBuilder(m_array->type()));
-
-        ThrowOnFailure(newValuesBuilder->AppendScalars(scalars));
-
-        std::shared_ptr<arrow::Array> newValues;
-        ThrowOnFailure(newValuesBuilder->Finish(&newValues));
 
-        // Return a new series with the reindexed values and new index
-        return { newValues, newIndex, m_name };
+        auto nulls = nullCount.load();
+        return { arrow::MakeArray(arrow::ArrayData::Make(
+                     m_array->type(),
+                     length,
+                     { nulls == 0 ? nullptr : bitmap, values },
+                     nulls)),
+                 newIndex,
+                 m_name };
     }
 
     GenericFunctionSeriesReturnDateTimeLike(day)
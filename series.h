@@ -212,6 +212,18 @@ public:
     virtual Series operator*(Series const& a) const;
     virtual Series operator*(Scalar const& a) const;
 
+    // compound assignment writes into this Series' own buffers when nothing
+    // else shares them and the result keeps the type, otherwise it replaces
+    // the array like s = s + a. The index is kept
+    Series& operator+=(Series const& a);
+    Series& operator+=(Scalar const& a);
+    Series& operator-=(Series const& a);
+    Series& operator-=(Scalar const& a);
+    Series& operator*=(Series const& a);
+    Series& operator*=(Scalar const& a);
+    Series& operator/=(Series const& a);
+    Series& operator/=(Scalar const& a);
+
     friend Series operator+(Scalar const& a, Series const& b);
     friend Series operator/(Scalar const& a, Series const& b);
     friend Series operator*(Scalar const& a, Series const& b);
@@ -262,6 +274,9 @@ public:
     [[nodiscard]] Scalar max() const;
     [[nodiscard]] Scalar product() const;
     [[nodiscard]] Scalar sum() const;
+
+    /// defers the arithmetic chained on the result, see LazyFrame
+    [[nodiscard]] class LazyFrame lazy() const;
     [[nodiscard]] DataFrame mode(int n, bool skip_nulls) const;
     [[nodiscard]] Scalar quantile(double q = 0.5) const;
     [[nodiscard]] Scalar tdigest(double q = 0.5) const;
@@ -284,10 +299,11 @@ public:
     [[nodiscard]] std::shared_ptr<arrow::DictionaryArray> dictionary_encode()
         const;
 
-    pd::Series reindex(std::shared_ptr<arrow::Array> const&newIndex,
-                       std::optional< std::unordered_map<int64_t, int64_t>>  indexer=std::nullopt) const noexcept;
-    pd::Series reindexAsync(std::shared_ptr<arrow::Array> const &newIndex,
-                            std::optional< std::unordered_map<int64_t, int64_t>>  indexer=std::nullopt) const noexcept;
+    /// the values at the labels of newIndex, null where a label is not in
+    /// the index. labels of another type are cast to the index type first
+    pd::Series reindex(std::shared_ptr<arrow::Array> const&newIndex) const;
+    /// reindex gathering the values in parallel morsels
+    pd::Series reindexAsync(std::shared_ptr<arrow::Array> const &newIndex) const;
 
     class Resampler resample(std::string const& rule,
                              bool closed_right = false,
@@ -399,6 +415,8 @@ private:
 
     std::vector<std::shared_ptr<arrow::Scalar>> to_vector() const;
 
+    Series& compoundAssign(std::string const& function, arrow::Datum const& other);
+
     std::vector<std::shared_ptr<arrow::Scalar>> get_indexed_values() const;
 
     static vector<double> ewm(
@@ -30,5 +30,14 @@ int main()
     std::cout << "elapsed time(s): "
               << std::chrono::duration<double>(end - start).count() << " s.\n";
 
+    start = std::chrono::high_resolution_clock::now();
+
+    auto lazyResult = (((df.lazy() + df) * df) / df).sum();
+
+    end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "elapsed time lazy(s): "
+              << std::chrono::duration<double>(end - start).count() << " s.\n";
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "../pandas_arrow.h"
+#include "catch.hpp"
+
+
+TEST_CASE("Test ChunkedSeries", "[Chunked]")
+{
+    pd::ChunkedSeries s{ pd::Series{ std::vector<double>{ 1, 2, 3 }, "x" } };
+    s.append(pd::Series{ std::vector<double>{ 4, 5 }, "x" });
+    s.append(pd::Series{ std::vector<double>{ 6 }, "x" });
+
+    REQUIRE(s.num_chunks() == 3);
+    REQUIRE(s.size() == 6);
+    REQUIRE(s.sum().as<double>() == 21);
+    REQUIRE(s.mean() == 3.5);
+    REQUIRE(s.min().as<double>() == 1);
+    REQUIRE(s.max().as<double>() == 6);
+    REQUIRE(s.count() == 6);
+
+    REQUIRE_THROWS(s.append(pd::Series{ std::vector<int>{ 1 }, "x" }));
+    REQUIRE_THROWS(s.append(pd::Series{ arrow::ArrayT<double>::Make({ 7 }),
+                                        arrow::ArrayT<int64_t>::Make({ 6 }),
+                                        "x" }));
+    REQUIRE(s.num_chunks() == 3);
+
+    auto doubled = s * pd::Scalar{ 2.0 };
+    REQUIRE(doubled.num_chunks() == 3);
+    REQUIRE(doubled.combine().equals(std::vector<double>{ 2, 4, 6, 8, 10, 12 }));
+
+    // differently chunked operands still line up with the index
+    auto other = pd::ChunkedSeries{ pd::Series{
+        std::vector<double>{ 1, 1, 1, 1, 1, 1 }, "y" } };
+    auto added = s + other;
+    REQUIRE(added.size() == 6);
+    REQUIRE(added.combine().equals(std::vector<double>{ 2, 3, 4, 5, 6, 7 }));
+    REQUIRE(added.index()->length() == 6);
+
+    auto sliced = s.slice(2, 3);
+    REQUIRE(sliced.num_chunks() == 2);
+    REQUIRE(sliced.combine().equals(std::vector<double>{ 3, 4, 5 }));
+
+    auto shifted = s.apply([](pd::Series const& chunk)
+                           { return chunk + pd::Scalar{ 1.0 }; });
+    REQUIRE(shifted.num_chunks() == 3);
+    REQUIRE(shifted.sum().as<double>() == 27);
+
+    // an empty chunk in the middle gets an empty index chunk
+    auto values = std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{
+        arrow::ArrayT<double>::Make({ 1, 2 }),
+        arrow::ArrayT<double>::Make({}),
+        arrow::ArrayT<double>::Make({ 3 }) });
+    auto index = std::make_shared<arrow::ChunkedArray>(
+        arrow::ArrayT<int64_t>::Make({ 10, 20, 30 }));
+    pd::ChunkedSeries withEmpty{ values, index, "x" };
+    REQUIRE(withEmpty.num_chunks() == 3);
+    REQUIRE(withEmpty.index()->Equals(index));
+    REQUIRE(withEmpty.combine().equals(std::vector<double>{ 1, 2, 3 }));
+    REQUIRE((withEmpty + withEmpty).size() == 3);
+}
+
+TEST_CASE("Test ChunkedDataFrame", "[Chunked]")
+{
+    auto day = [](int d)
+    {
+        return pd::DataFrame{
+            std::map<std::string, std::vector<int>>{
+                { "price", std::vector{ d * 10, d * 10 + 1 } },
+                { "volume", std::vector{ 100, 200 } } },
+            pd::date_range(date(2022, 10, 2 * d - 1), 2) };
+    };
+
+    pd::ChunkedDataFrame df{ day(1) };
+    df.append(day(2));
+    df.append(day(3));
+
+    REQUIRE(df.num_chunks() == 3);
+    REQUIRE(df.num_rows() == 6);
+    REQUIRE(df.columnNames() == std::vector<std::string>{ "price", "volume" });
+    REQUIRE(df["volume"].sum().as<int64_t>() == 900);
+    REQUIRE(df.chunk(1).equals_(day(2)));
+
+    auto combined = df.combine();
+    REQUIRE(combined.num_rows() == 6);
+    REQUIRE(combined.at(5, 0).as<int32_t>() == 31);
+    REQUIRE(combined.indexArray()->length() == 6);
+
+    auto sliced = df.slice(1, 2);
+    REQUIRE(sliced.num_chunks() == 2);
+    REQUIRE(sliced.combine().at(1, 0).as<int32_t>() == 20);
+
+    auto wrongSchema = pd::DataFrame{ std::map<std::string, std::vector<int>>{
+        { "price", std::vector{ 1 } } } };
+    REQUIRE_THROWS(df.append(wrongSchema));
+
+    pd::ChunkedDataFrame fromTable{ df.table() };
+    REQUIRE(fromTable.num_rows() == 6);
+    REQUIRE(fromTable.num_chunks() == 3);
+
+    auto withEmpty = pd::ReturnOrThrowOnFailure(arrow::Table::FromRecordBatches(
+        { day(1).m_array, day(2).m_array->Slice(0, 0), day(3).m_array }));
+    pd::ChunkedDataFrame fromEmptyChunk{ withEmpty };
+    REQUIRE(fromEmptyChunk.num_rows() == 4);
+    REQUIRE(fromEmptyChunk.index()->length() == 4);
+}
@@ -1229,4 +1229,48 @@ TEST_CASE("Concatenate with Series", "[concat]")
 ////        std::cout << result.shape()[0] << " " <<  result.shape()[1] << "]\n";
 ////    }
 //
-//}
\ No newline at end of file
+//}
+TEST_CASE("Test RangeIndex", "[core]")
+{
+    auto a = pd::RangeIndex{ 0, 5 }.array();
+    REQUIRE(a->length() == 5);
+    REQUIRE(a->Value(4) == 4);
+
+    // the default index is a view, slices of it stay views
+    pd::Series s{ std::vector<double>{ 1, 2, 3, 4, 5 } };
+    auto range = pd::RangeIndex::of(s.indexArray());
+    REQUIRE(range.has_value());
+    REQUIRE(*range == pd::RangeIndex{ 0, 5 });
+
+    auto sliced = pd::RangeIndex::of(s.indexArray()->Slice(2, 2));
+    REQUIRE(sliced.has_value());
+    REQUIRE(*sliced == pd::RangeIndex{ 2, 4 });
+    REQUIRE(sliced->position(arrow::Int32Scalar{ 3 }) == 1);
+    REQUIRE_FALSE(sliced->position(arrow::Int32Scalar{ 4 }).has_value());
+    REQUIRE_FALSE(sliced->position(arrow::Int64Scalar{ -1 }).has_value());
+
+    // materialized uint64 arrays are compared by value
+    auto materialized = pd::ReturnOrThrowOnFailure(
+        arrow::Concatenate({ a->Slice(0, 2), a->Slice(2, 3) }));
+    REQUIRE_FALSE(pd::RangeIndex::of(materialized).has_value());
+    REQUIRE(pd::indexEquals(a, materialized));
+    REQUIRE_FALSE(pd::indexEquals(a, pd::RangeIndex{ 1, 6 }.array()));
+
+    auto stepped = pd::RangeIndex{ 0, 10, 3 };
+    REQUIRE(stepped.size() == 4);
+    REQUIRE(stepped.array()->Value(3) == 9);
+    REQUIRE(stepped.position(arrow::UInt64Scalar{ 6 }) == 2);
+
+    // growing the shared buffer leaves existing views intact
+    auto big = pd::RangeIndex{ 0, 100000 }.array();
+    REQUIRE(big->Value(99999) == 99999);
+    REQUIRE(a->Value(4) == 4);
+
+    // a range far past the shared buffer only holds its own values
+    uint64_t far = 1'000'000'000'000;
+    auto tail = pd::RangeIndex{ far, far + 10 }.array();
+    REQUIRE(tail->data()->buffers[1]->size() == 10 * sizeof(uint64_t));
+    REQUIRE(tail->Value(9) == far + 9);
+    REQUIRE(pd::RangeIndex::of(tail->Slice(2, 3)) ==
+            pd::RangeIndex{ far + 2, far + 5 });
+}
@@ -1159,6 +1159,42 @@ TEST_CASE("Test reindex vs reindex_async benchmark", "[reindex]")
     }
 }
 
+TEST_CASE("Test eval and query", "[eval]")
+{
+    auto df = pd::DataFrame{
+        arrow::ArrayT<int64_t>::Make({ 10, 20, 30, 40 }),
+        std::pair{ "price"s, std::vector<double>{ 5, 12, 15, 8 } },
+        std::pair{ "qty"s, std::vector<int64_t>{ 1, 2, 7, 3 } },
+        std::pair{ "side"s, std::vector{ "buy"s, "sell"s, "buy"s, "sell"s } }
+    };
+
+    SECTION("eval")
+    {
+        auto result = df.eval("notional = price * qty - 1");
+        REQUIRE(result.num_columns() == 4);
+        REQUIRE(result["notional"].equals(std::vector<double>{ 4, 23, 104, 23 }));
+        REQUIRE(result.indexArray()->Equals(df.indexArray()));
+
+        auto replaced = df.eval("qty = -(qty + 1) * 2");
+        REQUIRE(replaced.num_columns() == 3);
+        REQUIRE(replaced["qty"].equals(std::vector<int64_t>{ -4, -6, -16, -8 }));
+
+        REQUIRE_THROWS(df.eval("price +"));
+        REQUIRE_THROWS(df.eval("missing * 2"));
+    }
+
+    SECTION("query")
+    {
+        auto result = df.query("price > 10 and qty < 5 or side == 'buy' and qty == 1");
+        REQUIRE(result.num_rows() == 2);
+        REQUIRE(result.indexArray()->Equals(
+            arrow::ArrayT<int64_t>::Make({ 10, 20 })));
+
+        REQUIRE(df.query("not (price >= 8.5)").num_rows() == 2);
+        REQUIRE_THROWS(df.query("price + 1"));
+    }
+}
+
 TEST_CASE("Test reindex function for DataFrame", "[reindex]")
 {
     // Create a test input DataFrame
@@ -1188,6 +1224,29 @@ TEST_CASE("Test reindex function for DataFrame", "[reindex]")
     auto expectedValues2 =
         arrow::ArrayT<::int64_t>::Make({ 5, 4, 2, 1, 0 }, { true, 1, 1, 1, 0 });
     REQUIRE(outputDataFrame["col2"].array()->Equals(expectedValues2));
+
+    // labels of another type are cast to the index type
+    auto unsignedIndex = arrow::ArrayT<::uint64_t>::Make({ 1, 2, 4, 5, 6 });
+    auto cast = inputDataFrame.reindexAsync(unsignedIndex);
+    REQUIRE(cast.indexArray()->Equals(unsignedIndex));
+    REQUIRE(cast["col1"].array()->Equals(expectedValues1));
+
+    // a long Series is gathered in several morsels
+    std::vector<int64_t> values(3 * pd::PD_MORSEL_SIZE);
+    std::iota(values.begin(), values.end(), 0);
+    pd::Series s{ values, "s" };
+    auto reversed = arrow::ArrayT<uint64_t>::Make(
+        std::vector<uint64_t>(values.rbegin(), values.rend()));
+    REQUIRE(s.reindexAsync(reversed).array()->Equals(
+        s.reindex(reversed).array()));
+
+    // the label past the end is missing
+    std::vector<uint64_t> ahead(values.size());
+    std::iota(ahead.begin(), ahead.end(), 1);
+    auto labels = arrow::ArrayT<uint64_t>::Make(ahead);
+    auto gathered = s.reindexAsync(labels).array();
+    REQUIRE(gathered->Equals(s.reindex(labels).array()));
+    REQUIRE(gathered->null_count() == 1);
 }
 
 TEST_CASE("Test reindex on datetime index", "[reindex]")
@@ -1270,4 +1329,410 @@ TEST_CASE("Test Transpose function", "[transpose]")
                        arrow::ArrayT<std::string>::Make(
                            { "name", "score", "employed", "kids" }) }));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test DataFrame compound assignment", "[parallel]")
+{
+    pd::DataFrame df(
+        std::map<std::string, std::vector<int64_t>>{ { "a", { 1, 2, 3 } },
+                                                     { "b", { 4, 5, 6 } } },
+        arrow::ArrayT<int64_t>::Make({ 10, 20, 30 }));
+    auto values = df.array()->column_data(0)->buffers[1]->data();
+
+    df += pd::Scalar(int64_t{ 1 });
+    df *= df["b"];
+    REQUIRE(df.array()->column_data(0)->buffers[1]->data() == values);
+    REQUIRE(df["a"].equals(std::vector<int64_t>{ 10, 18, 28 }));
+    REQUIRE(df["b"].equals(std::vector<int64_t>{ 25, 36, 49 }));
+    REQUIRE(df.indexArray()->Equals(arrow::ArrayT<int64_t>::Make({ 10, 20, 30 })));
+
+    // the copy keeps its values, the double result replaces the columns
+    auto copy = df;
+    df /= pd::Scalar(2.0);
+    REQUIRE(copy["a"].equals(std::vector<int64_t>{ 10, 18, 28 }));
+    REQUIRE(df["a"].equals(std::vector<double>{ 5, 9, 14 }));
+}
+
+TEST_CASE("Test GroupBy single pass aggregations", "[GroupBy]")
+{
+    pd::DataFrame df(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "key"s, std::vector<int64_t>{ 3, 1, 3, 2, 1, 3 } },
+        std::pair{ "value"s, std::vector<double>{ 1, 5, 2, 4, 6, 2 } });
+    auto groupby = df.group_by("key");
+    REQUIRE(groupby.groupSize() == 3);
+
+    auto sum = pd::ReturnOrThrowOnFailure(groupby.sum("value"));
+    REQUIRE(sum.equals(std::vector<double>{ 5, 11, 4 }));
+
+    auto count = pd::ReturnOrThrowOnFailure(groupby.count({ "key"s, "value"s }));
+    REQUIRE(count["value"].equals(std::vector<int64_t>{ 3, 2, 1 }));
+
+    auto minMax = pd::ReturnOrThrowOnFailure(groupby.min_max({ "value"s }));
+    REQUIRE(minMax["value_min"].equals(std::vector<double>{ 1, 5, 4 }));
+    REQUIRE(minMax["value_max"].equals(std::vector<double>{ 2, 6, 4 }));
+
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.first("value"))
+                .equals(std::vector<double>{ 1, 5, 4 }));
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.last("value"))
+                .equals(std::vector<double>{ 2, 6, 4 }));
+
+    // ties go to the smallest value
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.mode("value"))
+                .equals(std::vector<double>{ 2, 5, 4 }));
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.quantile("value", 0.5))
+                .equals(std::vector<double>{ 2, 5.5, 4 }));
+
+    REQUIRE_FALSE(groupby.sum("missing").ok());
+}
+
+TEST_CASE("Test GroupBy with multiple keys", "[GroupBy]")
+{
+    pd::DataFrame df(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "symbol"s, std::vector{ "A"s, "B"s, "A"s, "A"s, "B"s } },
+        std::pair{ "side"s, std::vector<int32_t>{ 1, 1, 2, 1, 1 } },
+        std::pair{ "qty"s, std::vector<int64_t>{ 10, 20, 30, 40, 50 } });
+    auto groupby = df.group_by(std::vector{ "symbol"s, "side"s });
+    REQUIRE(groupby.groupSize() == 3);
+
+    auto keys = std::static_pointer_cast<arrow::StructArray>(groupby.unique());
+    REQUIRE(keys->field(0)->Equals(arrow::ArrayT<std::string>::Make({ "A", "B", "A" })));
+    REQUIRE(keys->field(1)->Equals(arrow::ArrayT<int32_t>::Make({ 1, 1, 2 })));
+
+    auto qty = pd::ReturnOrThrowOnFailure(groupby.sum("qty"));
+    REQUIRE(qty.equals(std::vector<int64_t>{ 50, 70, 30 }));
+    REQUIRE(qty.indexArray()->Equals(groupby.unique()));
+
+    auto group = groupby.group(
+        arrow::ScalarVector{ arrow::MakeScalar("A"s), arrow::MakeScalar(int64_t{ 1 }) });
+    REQUIRE(group[2]->Equals(arrow::ArrayT<int64_t>::Make({ 10, 40 })));
+
+    // a column selection keeps the group ids and only splits its columns
+    auto selected = groupby["qty"];
+    REQUIRE(pd::ReturnOrThrowOnFailure(selected.max("qty"))
+                .equals(std::vector<int64_t>{ 40, 50, 30 }));
+    REQUIRE_FALSE(selected.sum("side").ok());
+    auto selectedGroup = selected.group(
+        arrow::ScalarVector{ arrow::MakeScalar("B"s), arrow::MakeScalar(int32_t{ 1 }) });
+    REQUIRE(selectedGroup.size() == 1);
+    REQUIRE(selectedGroup[0]->Equals(arrow::ArrayT<int64_t>::Make({ 20, 50 })));
+}
+
+TEST_CASE("Test GroupBy across morsels", "[GroupBy]")
+{
+    // a few groups merge thread local states, many take the radix partitions
+    auto n = 3 * pd::PD_MORSEL_SIZE + 123;
+    for (int64_t cardinality : { int64_t{ 7 }, int64_t{ 100003 } })
+    {
+        std::vector<int64_t> keys(n);
+        std::vector<double> values(n);
+        std::unordered_map<int64_t, size_t> position;
+        std::vector<int64_t> order, counts;
+        std::vector<double> sums, maxes;
+        for (int64_t row = 0; row < n; ++row)
+        {
+            keys[row] = (row * 7919) % cardinality;
+            values[row] = static_cast<double>(row % 1000);
+            auto inserted = position.try_emplace(keys[row], order.size());
+            if (inserted.second)
+            {
+                order.push_back(keys[row]);
+                counts.push_back(0);
+                sums.push_back(0);
+                maxes.push_back(values[row]);
+            }
+            auto group = inserted.first->second;
+            ++counts[group];
+            sums[group] += values[row];
+            maxes[group] = std::max(maxes[group], values[row]);
+        }
+
+        pd::DataFrame df(
+            pd::ArrayPtr{ nullptr },
+            std::pair{ "key"s, keys },
+            std::pair{ "value"s, values });
+        auto groupby = df.group_by("key");
+        REQUIRE(groupby.unique()->Equals(arrow::ArrayT<int64_t>::Make(order)));
+
+        REQUIRE(pd::ReturnOrThrowOnFailure(groupby.sum("value")).equals(sums));
+        REQUIRE(pd::ReturnOrThrowOnFailure(groupby.count("value")).equals(counts));
+        REQUIRE(pd::ReturnOrThrowOnFailure(groupby.max("value")).equals(maxes));
+
+        double mean = sums[0] / static_cast<double>(counts[0]), squares = 0;
+        for (int64_t row = 0; row < n; ++row)
+        {
+            if (keys[row] == order[0])
+            {
+                squares += (values[row] - mean) * (values[row] - mean);
+            }
+        }
+        auto variance = pd::ReturnOrThrowOnFailure(groupby.variance("value"));
+        REQUIRE(variance[0].as<double>() ==
+                Catch::Approx(squares / static_cast<double>(counts[0])));
+    }
+}
+
+TEST_CASE("Test GroupBy transform", "[GroupBy]")
+{
+    pd::DataFrame df(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "sym"s, std::vector{ "a"s, "b"s, "a"s, "b"s, "a"s } },
+        std::pair{ "px"s, std::vector<double>{ 1, 10, 3, 20, 5 } });
+    auto groupby = df.group_by("sym");
+
+    auto mean = pd::ReturnOrThrowOnFailure(groupby.transform("mean", "px"));
+    REQUIRE(mean.equals(std::vector<double>{ 3, 15, 3, 15, 3 }));
+    REQUIRE(mean.indexArray()->Equals(df.indexArray()));
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.transform("last", "px"))
+                .equals(std::vector<double>{ 5, 20, 5, 20, 5 }));
+
+    auto demeaned = pd::ReturnOrThrowOnFailure(groupby.transform(
+        [](pd::Series const& group) { return group - pd::Scalar(group.mean()); },
+        "px"));
+    REQUIRE(demeaned.equals(std::vector<double>{ -2, -5, 0, 5, 2 }));
+
+    // a single value is broadcast over the group
+    auto peak = pd::ReturnOrThrowOnFailure(groupby.transform(
+        [](pd::Series const& group)
+        { return pd::Series(std::vector{ group.max().as<double>() }); },
+        "px"));
+    REQUIRE(peak.equals(std::vector<double>{ 5, 20, 5, 20, 5 }));
+
+    REQUIRE_FALSE(groupby
+                      .transform(
+                          [](pd::Series const&)
+                          { return pd::Series(std::vector<double>{ 1, 2 }); },
+                          "px")
+                      .ok());
+
+    pd::DataFrame empty(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "sym"s, std::vector<std::string>{} },
+        std::pair{ "px"s, std::vector<double>{} });
+    auto none = pd::ReturnOrThrowOnFailure(empty.group_by("sym").transform(
+        [](pd::Series const& s) { return s; },
+        "px"));
+    REQUIRE(none.size() == 0);
+}
+
+TEST_CASE("Test GroupBy window functions", "[GroupBy]")
+{
+    pd::DataFrame df(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "sym"s, std::vector{ "a"s, "b"s, "a"s, "b"s, "a"s, "a"s } },
+        std::pair{ "px"s, std::vector<double>{ 1, 10, 3, 20, 2, 4 } });
+    auto groupby = df.group_by("sym");
+
+    auto cumsum = pd::ReturnOrThrowOnFailure(groupby.cumsum("px"));
+    REQUIRE(cumsum.equals(std::vector<double>{ 1, 10, 4, 30, 6, 10 }));
+    REQUIRE(cumsum.indexArray()->Equals(df.indexArray()));
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.cumprod("px"))
+                .equals(std::vector<double>{ 1, 10, 3, 200, 6, 24 }));
+
+    auto shifted = pd::ReturnOrThrowOnFailure(groupby.shift("px"));
+    REQUIRE(shifted.m_array->Equals(arrow::ArrayT<double>::Make(
+        { 0, 0, 1, 10, 3, 2 },
+        { false, false, true, true, true, true })));
+    auto diff = pd::ReturnOrThrowOnFailure(groupby.diff("px"));
+    REQUIRE(diff.m_array->Equals(arrow::ArrayT<double>::Make(
+        { 0, 0, 2, 10, -1, 2 },
+        { false, false, true, true, true, true })));
+
+    // "c" has a single row, shorter than the shift in either direction
+    pd::DataFrame shortGroups(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "sym"s, std::vector{ "a"s, "c"s, "a"s, "a"s } },
+        std::pair{ "px"s, std::vector<double>{ 1, 5, 3, 6 } });
+    auto shortGroupBy = shortGroups.group_by("sym");
+    REQUIRE(pd::ReturnOrThrowOnFailure(shortGroupBy.shift("px", 2))
+                .m_array->Equals(arrow::ArrayT<double>::Make(
+                    { 0, 0, 0, 1 }, { false, false, false, true })));
+    REQUIRE(pd::ReturnOrThrowOnFailure(shortGroupBy.shift("px", -2))
+                .m_array->Equals(arrow::ArrayT<double>::Make(
+                    { 6, 0, 0, 0 }, { true, false, false, false })));
+    REQUIRE(pd::ReturnOrThrowOnFailure(
+                shortGroupBy.shift("px", 2, arrow::MakeScalar(0)))
+                .equals(std::vector<double>{ 0, 0, 0, 1 }));
+    REQUIRE(pd::ReturnOrThrowOnFailure(shortGroupBy.diff("px", 2))
+                .m_array->Equals(arrow::ArrayT<double>::Make(
+                    { 0, 0, 0, 5 }, { false, false, false, true })));
+    REQUIRE(pd::ReturnOrThrowOnFailure(shortGroupBy.diff("px", -2))
+                .m_array->Equals(arrow::ArrayT<double>::Make(
+                    { -5, 0, 0, 0 }, { true, false, false, false })));
+
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.rank("px"))
+                .equals(std::vector<uint64_t>{ 1, 1, 3, 2, 2, 4 }));
+
+    auto rolling = pd::ReturnOrThrowOnFailure(groupby.rolling(2).mean("px"));
+    REQUIRE(rolling.m_array->Equals(arrow::ArrayT<double>::Make(
+        { 0, 0, 2, 15, 2.5, 3 },
+        { false, false, true, true, true, true })));
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.rolling(3, 1).sum("px"))
+                .equals(std::vector<double>{ 1, 10, 4, 30, 6, 9 }));
+
+    // an infinity leaves the window without turning the sums into NaN
+    auto inf = std::numeric_limits<double>::infinity();
+    pd::DataFrame withInf(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "sym"s, std::vector{ "a"s, "a"s, "b"s, "a"s, "a"s, "a"s } },
+        std::pair{ "px"s, std::vector<double>{ 1, inf, 7, 2, 3, -inf } });
+    auto infGroupBy = withInf.group_by("sym");
+    REQUIRE(pd::ReturnOrThrowOnFailure(infGroupBy.rolling(2).sum("px"))
+                .m_array->Equals(arrow::ArrayT<double>::Make(
+                    { 0, inf, 0, inf, 5, -inf },
+                    { false, true, false, true, true, true })));
+    REQUIRE(pd::ReturnOrThrowOnFailure(infGroupBy.rolling(2, 1).mean("px"))
+                .equals(std::vector<double>{ 1, inf, 7, inf, 2.5, -inf }));
+    auto mixed = pd::ReturnOrThrowOnFailure(infGroupBy.rolling(5, 1).sum("px"));
+    REQUIRE(std::isnan(mixed[5].as<double>()));
+}
+
+TEST_CASE("Test GroupBy agg", "[GroupBy]")
+{
+    pd::DataFrame df(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "sym"s, std::vector{ "a"s, "b"s, "a"s, "b"s, "a"s } },
+        std::pair{ "px"s, std::vector<double>{ 1, 10, 3, 20, 5 } },
+        std::pair{ "qty"s, std::vector<int64_t>{ 1, 2, 3, 4, 5 } });
+    auto groupby = df.group_by("sym");
+
+    auto result = pd::ReturnOrThrowOnFailure(groupby.agg(
+        { { "px", { "mean", "std", "min", "max", "first" } },
+          { "qty", { "sum" } } }));
+    REQUIRE(result.columnNames() ==
+            std::vector<std::string>{
+                "px_mean", "px_std", "px_min", "px_max", "px_first", "qty" });
+    REQUIRE(result.indexArray()->Equals(groupby.unique()));
+
+    REQUIRE(result["px_mean"].equals(std::vector<double>{ 3, 15 }));
+    REQUIRE(result["px_std"][0].as<double>() == Catch::Approx(std::sqrt(8.0 / 3)));
+    REQUIRE(result["px_std"][1].as<double>() == Catch::Approx(5));
+    REQUIRE(result["px_min"].equals(std::vector<double>{ 1, 10 }));
+    REQUIRE(result["px_max"].equals(std::vector<double>{ 5, 20 }));
+    REQUIRE(result["px_first"].equals(std::vector<double>{ 1, 10 }));
+    REQUIRE(result["qty"].equals(std::vector<int64_t>{ 9, 6 }));
+
+    REQUIRE_FALSE(groupby.agg({ { "missing", { "sum" } } }).ok());
+}
+
+TEST_CASE("Test GroupBy over sorted keys", "[GroupBy]")
+{
+    pd::DataFrame df(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "key"s, std::vector<int64_t>{ 1, 1, 2, 2, 2, 5 } },
+        std::pair{ "value"s, std::vector<double>{ 1, 2, 3, 4, 5, 6 } });
+
+    // a monotonic key is grouped by runs, groups are slices of the columns
+    auto groupby = df.group_by("key");
+    REQUIRE(groupby.unique()->Equals(arrow::ArrayT<int64_t>::Make({ 1, 2, 5 })));
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.sum("value"))
+                .equals(std::vector<double>{ 3, 12, 6 }));
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.last("value"))
+                .equals(std::vector<double>{ 2, 5, 6 }));
+    REQUIRE(pd::ReturnOrThrowOnFailure(groupby.cumsum("value"))
+                .equals(std::vector<double>{ 1, 3, 3, 7, 12, 6 }));
+    auto group = groupby.group(int64_t{ 2 });
+    REQUIRE(group[1]->Equals(arrow::ArrayT<double>::Make({ 3, 4, 5 })));
+    REQUIRE(group[1]->data()->buffers[1] == df.m_array->column(1)->data()->buffers[1]);
+
+    // sorted only asserts that equal keys are adjacent, each run is a group
+    pd::DataFrame runs(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "sym"s, std::vector{ "b"s, "b"s, "a"s, "a"s, "b"s } },
+        std::pair{ "qty"s, std::vector<int64_t>{ 1, 2, 3, 4, 5 } });
+    REQUIRE(runs.group_by("sym").groupSize() == 2);
+    auto byRuns = runs.group_by("sym", true);
+    REQUIRE(byRuns.groupSize() == 3);
+    REQUIRE(pd::ReturnOrThrowOnFailure(byRuns.sum("qty"))
+                .equals(std::vector<int64_t>{ 3, 7, 5 }));
+
+    // -0.0 compares equal to 0.0 but is a key of its own, floats are hashed
+    pd::DataFrame zeros(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "key"s, std::vector<double>{ 0.0, -0.0, 0.0 } },
+        std::pair{ "qty"s, std::vector<int64_t>{ 1, 2, 3 } });
+    REQUIRE(zeros.group_by("key").groupSize() == 2);
+}
+
+TEST_CASE("Test apply_async over many small groups", "[GroupBy]")
+{
+    // more groups than one batch, so several builders are stitched in order
+    int64_t numGroups = 20000;
+    std::vector<int64_t> keys, values;
+    for (int64_t row = 0; row < 3 * numGroups; ++row)
+    {
+        keys.push_back(row % numGroups);
+        values.push_back(row);
+    }
+    pd::DataFrame df(
+        pd::ArrayPtr{ nullptr },
+        std::pair{ "key"s, keys },
+        std::pair{ "value"s, values });
+    auto groupby = df.group_by("key");
+
+    auto result = pd::ReturnOrThrowOnFailure(groupby["value"].apply_async(
+        [](pd::Series const& s) -> std::shared_ptr<arrow::Scalar>
+        { return s.sum().scalar; }));
+    REQUIRE(result.num_rows() == numGroups);
+    auto sums = result["value"].values<int64_t>();
+    for (int64_t group = 0; group < numGroups; ++group)
+    {
+        REQUIRE(sums[group] == 3 * group + 3 * numGroups);
+    }
+}
+
+TEST_CASE("Test StreamingGroupBy", "[GroupBy]")
+{
+    auto frame = [](std::vector<std::string> const& sym,
+                    std::vector<double> const& px,
+                    std::vector<int64_t> const& qty)
+    {
+        return pd::DataFrame(
+            pd::ArrayPtr{ nullptr },
+            std::pair{ "sym"s, sym },
+            std::pair{ "px"s, px },
+            std::pair{ "qty"s, qty });
+    };
+    std::vector<std::pair<std::string, std::vector<std::string>>> aggregations{
+        { "px", { "sum", "count", "mean", "min", "max", "last", "std", "var" } },
+        { "qty", { "sum" } }
+    };
+
+    pd::StreamingGroupBy stream("sym", aggregations);
+    REQUIRE_FALSE(stream.snapshot().ok());
+
+    REQUIRE(stream.consume(frame({ "a", "b", "a" }, { 1, 10, 3 }, { 1, 2, 3 })).ok());
+    auto first = pd::ReturnOrThrowOnFailure(stream.snapshot());
+    REQUIRE(first["px_sum"].equals(std::vector<double>{ 4, 10 }));
+    REQUIRE(first["px_last"].equals(std::vector<double>{ 3, 10 }));
+    REQUIRE(first["qty"].equals(std::vector<int64_t>{ 4, 2 }));
+
+    REQUIRE(stream.consume(frame({ "b", "c" }, { 20, 7 }, { 4, 6 })).ok());
+    REQUIRE(stream.consume(frame({ "a", "c", "b" }, { 5, 9, 30 }, { 5, 7, 8 })).ok());
+    REQUIRE(stream.groupSize() == 3);
+
+    // the same frame as grouping every row at once
+    auto all = frame(
+        { "a", "b", "a", "b", "c", "a", "c", "b" },
+        { 1, 10, 3, 20, 7, 5, 9, 30 },
+        { 1, 2, 3, 4, 6, 5, 7, 8 });
+    auto expected = pd::ReturnOrThrowOnFailure(all.group_by("sym").agg(aggregations));
+    auto result = pd::ReturnOrThrowOnFailure(stream.snapshot());
+    REQUIRE(result.columnNames() == expected.columnNames());
+    REQUIRE(result.indexArray()->Equals(expected.indexArray()));
+    REQUIRE(result.array()->ApproxEquals(*expected.array()));
+
+    // the types of the first batch stay
+    REQUIRE_FALSE(stream
+                      .consume(pd::DataFrame(
+                          pd::ArrayPtr{ nullptr },
+                          std::pair{ "sym"s, std::vector{ "a"s } },
+                          std::pair{ "px"s, std::vector<int64_t>{ 1 } },
+                          std::pair{ "qty"s, std::vector<int64_t>{ 1 } }))
+                      .ok());
+    REQUIRE(stream.groupSize() == 3);
+    REQUIRE_THROWS_AS(
+        pd::StreamingGroupBy("sym", { { "px", { "mode" } } }),
+        std::invalid_argument);
+}
@@ -0,0 +1,306 @@
+#include "../pandas_arrow.h"
+#include "catch.hpp"
+#include <fstream>
+#include <parquet/api/writer.h>
+#include <parquet/arrow/writer.h>
+
+
+static std::filesystem::path writeRowGroups(int64_t chunk_size)
+{
+    auto a = arrow::ArrayT<int64_t>::Make({ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+    auto b = arrow::ArrayT<double>::Make(
+        { 0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0, 3.5, 4.0, 4.5 });
+
+    auto table = arrow::Table::Make(
+        arrow::schema({ arrow::field("a", arrow::int64()),
+                        arrow::field("b", arrow::float64()) }),
+        { a, b });
+
+    auto path = std::filesystem::temp_directory_path() / "io_test.parquet";
+    auto outfile =
+        pd::ReturnOrThrowOnFailure(arrow::io::FileOutputStream::Open(path));
+    PARQUET_THROW_NOT_OK(parquet::arrow::WriteTable(
+        *table, arrow::default_memory_pool(), outfile, chunk_size));
+    PARQUET_THROW_NOT_OK(outfile->Close());
+    return path;
+}
+
+/// price as decimal(9, 2) stored in INT32, two row groups of 10.00..10.03
+/// and 12.34..12.37
+static std::filesystem::path writeDecimalRowGroups()
+{
+    using parquet::schema::GroupNode;
+    using parquet::schema::PrimitiveNode;
+
+    auto price = PrimitiveNode::Make(
+        "price",
+        parquet::Repetition::REQUIRED,
+        parquet::LogicalType::Decimal(9, 2),
+        parquet::Type::INT32);
+    auto schema = std::static_pointer_cast<GroupNode>(
+        GroupNode::Make("schema", parquet::Repetition::REQUIRED, { price }));
+
+    auto path = std::filesystem::temp_directory_path() / "io_test_decimal.parquet";
+    auto outfile =
+        pd::ReturnOrThrowOnFailure(arrow::io::FileOutputStream::Open(path));
+    auto writer = parquet::ParquetFileWriter::Open(outfile, schema);
+    for (int32_t first : { 1000, 1234 })
+    {
+        auto rowGroup = writer->AppendRowGroup();
+        auto column = static_cast<parquet::Int32Writer*>(rowGroup->NextColumn());
+        std::vector<int32_t> unscaled{ first, first + 1, first + 2, first + 3 };
+        column->WriteBatch(
+            static_cast<int64_t>(unscaled.size()), nullptr, nullptr, unscaled.data());
+        rowGroup->Close();
+    }
+    writer->Close();
+    PARQUET_THROW_NOT_OK(outfile->Close());
+    return path;
+}
+
+TEST_CASE("Test readParquet with multiple row groups", "[IO]")
+{
+    auto path = writeRowGroups(4);
+
+    auto df = pd::DataFrame::readParquet(path);
+    REQUIRE(df.num_rows() == 10);
+    REQUIRE(df.columnNames() == std::vector<std::string>{ "a", "b" });
+    REQUIRE(df.at(9, 0).as<int64_t>() == 9);
+    REQUIRE(df.at(5, 1).as<double>() == 2.5);
+}
+
+TEST_CASE("Test readParquetBatches", "[IO]")
+{
+    auto path = writeRowGroups(4);
+
+    SECTION("one batch per row group")
+    {
+        auto prefetch = GENERATE(true, false);
+        auto reader = pd::DataFrame::readParquetBatches(
+            path, pd::ParquetReadOptions{ .prefetch = prefetch });
+
+        std::vector<int64_t> sizes;
+        int64_t expected = 0;
+        while (auto batch = reader.next())
+        {
+            sizes.push_back(batch->num_rows());
+            REQUIRE(batch->at(0, 0).as<int64_t>() == expected);
+            REQUIRE(std::static_pointer_cast<arrow::UInt64Array>(batch->indexArray())
+                        ->Value(0) == static_cast<uint64_t>(expected));
+            expected += batch->num_rows();
+        }
+        REQUIRE(sizes == std::vector<int64_t>{ 4, 4, 2 });
+        REQUIRE_FALSE(reader.next().has_value());
+    }
+
+    SECTION("fixed batch size")
+    {
+        auto reader = pd::DataFrame::readParquetBatches(
+            path, pd::ParquetReadOptions{ .batch_size = 3 });
+
+        int64_t total = 0;
+        while (auto batch = reader.next())
+        {
+            REQUIRE(batch->num_rows() <= 3);
+            total += batch->num_rows();
+        }
+        REQUIRE(total == 10);
+    }
+}
+
+TEST_CASE("Test readParquet projection and filter", "[IO]")
+{
+    using namespace arrow::compute;
+    auto path = writeRowGroups(4);
+
+    pd::ParquetReadOptions options;
+    options.columns = { "b" };
+    options.filter = greater_equal(field_ref("a"), literal(int64_t{ 6 }));
+
+    auto df = pd::DataFrame::readParquet(path, options);
+    REQUIRE(df.columnNames() == std::vector<std::string>{ "b" });
+    REQUIRE(df.num_rows() == 4);
+    REQUIRE(df.at(0, 0).as<double>() == 3.0);
+    REQUIRE(df.at(3, 0).as<double>() == 4.5);
+
+    // the first row group cannot match and is never yielded
+    auto reader = pd::DataFrame::readParquetBatches(path, options);
+    REQUIRE(reader.schema()->num_fields() == 1);
+
+    std::vector<int64_t> sizes;
+    while (auto batch = reader.next())
+    {
+        sizes.push_back(batch->num_rows());
+    }
+    REQUIRE(sizes == std::vector<int64_t>{ 2, 2 });
+
+    options.columns = { "b", "b" };
+    REQUIRE(pd::DataFrame::readParquet(path, options).columnNames() ==
+            std::vector<std::string>{ "b" });
+    auto deduplicated = pd::DataFrame::readParquetBatches(path, options);
+    REQUIRE(deduplicated.schema()->num_fields() == 1);
+    REQUIRE(deduplicated.next()->num_columns() == 1);
+
+    options.columns = { "c" };
+    REQUIRE_THROWS(pd::DataFrame::readParquet(path, options));
+}
+
+TEST_CASE("Test readParquet filter on a decimal column", "[IO]")
+{
+    using namespace arrow::compute;
+    auto path = writeDecimalRowGroups();
+
+    // the INT32 statistics are unscaled, 1000 is 10.00 and not 1000.00, so
+    // the first row group must not be pruned
+    pd::ParquetReadOptions options;
+    options.filter = less_equal(
+        field_ref("price"),
+        literal(std::make_shared<arrow::Decimal128Scalar>(
+            arrow::Decimal128(1200), arrow::decimal128(9, 2))));
+
+    auto df = pd::DataFrame::readParquet(path, options);
+    REQUIRE(df.num_rows() == 4);
+    REQUIRE(df.at(0, 0).scalar->Equals(arrow::Decimal128Scalar(
+        arrow::Decimal128(1000), arrow::decimal128(9, 2))));
+}
+
+TEST_CASE("Test Feather round trip", "[IO]")
+{
+    auto df =
+        pd::DataFrame{ std::map<std::string, std::vector<int>>{
+                           { "month", std::vector{ 1, 4, 7, 10 } },
+                           { "sale", std::vector{ 55, 40, 84, 31 } } },
+                       pd::date_range(date(2022, 10, 1), 4) };
+
+    auto path = std::filesystem::temp_directory_path() / "io_test.feather";
+    df.toFeather(path);
+
+    auto mmap = GENERATE(true, false);
+    auto loaded = pd::DataFrame::readFeather(path, mmap);
+
+    REQUIRE(loaded.columnNames() == df.columnNames());
+    REQUIRE(loaded.indexArray()->Equals(df.indexArray()));
+    REQUIRE(loaded.equals_(df));
+    REQUIRE(loaded.m_array->schema()->metadata() == nullptr);
+
+    // a data column may be called index, the stored index may not shadow it
+    pd::DataFrame indexed{ std::map<std::string, std::vector<int>>{
+        { "index", std::vector{ 3, 2, 1 } } } };
+    indexed.toFeather(path);
+    REQUIRE(pd::DataFrame::readFeather(path, mmap).equals_(indexed));
+    REQUIRE_THROWS(indexed.toFeather(path, "index"));
+}
+
+TEST_CASE("Test read_csv", "[IO]")
+{
+    auto path = std::filesystem::temp_directory_path() / "io_test.csv";
+    {
+        std::ofstream file(path);
+        file << "date,symbol,price,volume\n";
+        for (int i = 1; i <= 20; i++)
+        {
+            file << "2022/10/" << (i < 10 ? "0" : "") << i << ",abc," << i
+                 << ".5," << i * 100 << "\n";
+        }
+    }
+
+    pd::CsvReadOptions options;
+    options.index_col = "date";
+    options.parse_dates = { "date" };
+    options.date_formats = { "%Y/%m/%d" };
+    options.dtype["volume"] = arrow::int32();
+    // small blocks so the file is split and parsed concurrently
+    options.block_size = 128;
+
+    auto df = pd::read_csv(path, options);
+
+    REQUIRE(df.num_rows() == 20);
+    REQUIRE(df.columnNames() ==
+            std::vector<std::string>{ "symbol", "price", "volume" });
+    REQUIRE(df["price"].dtype()->id() == arrow::Type::DOUBLE);
+    REQUIRE(df["volume"].dtype()->id() == arrow::Type::INT32);
+    REQUIRE(df.indexArray()->Equals(pd::date_range(date(2022, 10, 1), 20)));
+    REQUIRE(df.at(19, 2).as<int32_t>() == 2000);
+}
+
+TEST_CASE("Test toParquet round trip", "[IO]")
+{
+    auto df =
+        pd::DataFrame{ std::map<std::string, std::vector<int>>{
+                           { "month", std::vector{ 1, 4, 7, 10, 1, 4 } },
+                           { "sale", std::vector{ 55, 40, 84, 31, 12, 9 } } },
+                       pd::date_range(date(2022, 10, 1), 6) };
+
+    auto path = std::filesystem::temp_directory_path() / "io_test_write.parquet";
+
+    pd::ParquetWriteOptions options;
+    options.row_group_size = 4;
+    options.column_dictionary["sale"] = false;
+    df.toParquet(path, options);
+
+    auto loaded = pd::DataFrame::readParquet(path);
+    REQUIRE(loaded.columnNames() == df.columnNames());
+    REQUIRE(loaded.indexArray()->Equals(df.indexArray()));
+    REQUIRE(loaded.equals_(df));
+
+    auto projected = pd::DataFrame::readParquet(
+        path, pd::ParquetReadOptions{ .columns = { "sale" } });
+    REQUIRE(projected.columnNames() == std::vector<std::string>{ "sale" });
+    REQUIRE(projected.indexArray()->Equals(df.indexArray()));
+
+    auto reader = pd::DataFrame::readParquetBatches(path);
+    REQUIRE(reader.schema()->num_fields() == 2);
+    auto first = reader.next();
+    REQUIRE(first->num_rows() == 4);
+    REQUIRE(first->indexArray()->Equals(df.indexArray()->Slice(0, 4)));
+}
+
+TEST_CASE("Test Dataset partition pruning", "[IO]")
+{
+    using namespace arrow::compute;
+
+    auto root = std::filesystem::temp_directory_path() / "io_test_dataset";
+    std::filesystem::remove_all(root);
+    for (int day = 1; day <= 3; day++)
+    {
+        for (std::string symbol : { "abc", "xyz" })
+        {
+            auto dir = root / ("day=" + std::to_string(day)) / ("symbol=" + symbol);
+            std::filesystem::create_directories(dir);
+
+            auto table = arrow::Table::Make(
+                arrow::schema({ arrow::field("price", arrow::float64()) }),
+                { arrow::ArrayT<double>::Make({ day + 0.25, day + 0.5 }) });
+            auto outfile = pd::ReturnOrThrowOnFailure(
+                arrow::io::FileOutputStream::Open(dir / "part.parquet"));
+            PARQUET_THROW_NOT_OK(parquet::arrow::WriteTable(
+                *table, arrow::default_memory_pool(), outfile, 1024));
+            PARQUET_THROW_NOT_OK(outfile->Close());
+        }
+    }
+
+    pd::Dataset dataset{ root };
+    REQUIRE(dataset.schema()->GetFieldIndex("day") != -1);
+    REQUIRE(dataset.schema()->GetFieldIndex("symbol") != -1);
+
+    REQUIRE(dataset.read().num_rows() == 12);
+
+    pd::DatasetScanOptions options;
+    options.columns = { "price", "day" };
+    options.filter = and_(
+        equal(field_ref("day"), literal(2)),
+        equal(field_ref("symbol"), literal("xyz")));
+
+    auto df = dataset.read(options);
+    REQUIRE(df.columnNames() == std::vector<std::string>{ "price", "day" });
+    REQUIRE(df.num_rows() == 2);
+    REQUIRE(df.at(0, 0).as<double>() == 2.25);
+
+    auto reader = dataset.readBatches(options);
+    int64_t total = 0;
+    while (auto batch = reader.next())
+    {
+        total += batch->num_rows();
+    }
+    REQUIRE(total == 2);
+}
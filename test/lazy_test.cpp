@@ -0,0 +1,145 @@
+#include "../pandas_arrow.h"
+#include "catch.hpp"
+
+
+TEST_CASE("Test LazyFrame", "[Lazy]")
+{
+    pd::DataFrame df(
+        std::map<std::string, std::vector<int64_t>>{ { "a", { 1, 2, 3, 4 } },
+                                                     { "b", { 5, 6, 7, 8 } } },
+        arrow::ArrayT<int64_t>::Make({ 10, 20, 30, 40 }));
+
+    SECTION("matches the eager operators")
+    {
+        auto lazy = (((df.lazy() + df) * df) / df).evaluate();
+        auto eager = ((df + df) * df) / df;
+        REQUIRE(lazy.array()->Equals(*eager.array()));
+        REQUIRE(lazy.indexArray()->Equals(df.indexArray()));
+        REQUIRE((((df.lazy() + df) * df) / df).sum().as<int64_t>() ==
+                eager.sum().as<int64_t>());
+    }
+
+    SECTION("constants, series and mixed types")
+    {
+        pd::Series s{ std::vector<double>{ 0.5, 1, 1.5, 2 }, "s" };
+
+        auto result = (df.lazy() * 2 - s).evaluate();
+        REQUIRE(result["a"].equals(std::vector<double>{ 1.5, 3, 4.5, 6 }));
+        REQUIRE(result["b"].equals(std::vector<double>{ 9.5, 11, 12.5, 14 }));
+
+        REQUIRE((df.lazy() / 2).evaluate()["a"].equals(
+            std::vector<int64_t>{ 0, 1, 1, 2 }));
+        REQUIRE((s.lazy() + 1).mean().as<double>() == 2.25);
+        REQUIRE((df.lazy() - s).min().as<double>() == 0.5);
+        REQUIRE((df.lazy() - 1).max().as<int64_t>() == 7);
+    }
+
+    SECTION("nulls propagate and are skipped by reductions")
+    {
+        pd::Series s{ arrow::ArrayT<int64_t>::Make(
+                          { 1, 0, 1, 1 }, { true, false, true, true }),
+                      nullptr };
+
+        auto result = (s.lazy() * 10).evaluate();
+        REQUIRE(result.array()->column(0)->null_count() == 1);
+        REQUIRE((df.lazy() / s).sum().as<int64_t>() == 1 + 3 + 4 + 5 + 7 + 8);
+    }
+
+    SECTION("errors")
+    {
+        pd::Series zeros{ std::vector<int64_t>{ 1, 0, 1, 1 }, "z" };
+        REQUIRE_THROWS((df.lazy() / zeros).evaluate());
+
+        pd::Series shorter{ std::vector<int64_t>{ 1, 2 }, "z" };
+        REQUIRE_THROWS((df.lazy() + shorter).sum());
+    }
+}
+
+TEST_CASE("Test LazyFrame plan", "[Lazy]")
+{
+    pd::DataFrame df(
+        std::map<std::string, std::vector<int64_t>>{
+            { "key", { 1, 2, 1, 2, 1 } },
+            { "price", { 10, 20, 30, 40, 50 } },
+            { "qty", { 1, 2, 3, 4, 5 } } },
+        arrow::ArrayT<int64_t>::Make({ 10, 20, 30, 40, 50 }));
+
+    SECTION("filters are pushed below assignments and selections")
+    {
+        auto plan = df.lazy()
+                        .assign("notional = price * qty")
+                        .select({ "key", "notional", "price" })
+                        .where("price > 15")
+                        .select({ "notional" });
+        auto explained = plan.explain();
+        REQUIRE(explained.find("Assign") < explained.find("Filter"));
+        // price is dropped by the last select, key by the pruning
+        REQUIRE(explained.find("Frame([price, qty])") != std::string::npos);
+
+        auto result = plan.collect();
+        REQUIRE(result.columnNames() == std::vector<std::string>{ "notional" });
+        REQUIRE(result["notional"].equals(std::vector<int64_t>{ 40, 90, 160, 250 }));
+        REQUIRE(result.indexArray()->Equals(
+            arrow::ArrayT<int64_t>::Make({ 20, 30, 40, 50 })));
+    }
+
+    SECTION("group_by, sort_values and slice")
+    {
+        auto result = df.lazy()
+                          .group_by({ "key" }, { { "qty", "sum" }, { "price", "max" } })
+                          .sort_values({ "qty" }, false)
+                          .slice(0, 1)
+                          .collect();
+        REQUIRE(result.columnNames() ==
+                std::vector<std::string>{ "key", "qty", "price" });
+        REQUIRE(result["key"].equals(std::vector<int64_t>{ 1 }));
+        REQUIRE(result["qty"].equals(std::vector<int64_t>{ 9 }));
+        REQUIRE(result["price"].equals(std::vector<int64_t>{ 50 }));
+    }
+
+    SECTION("arithmetic feeds a plan")
+    {
+        auto result = (df.lazy() * 2).where("key == 4").collect();
+        REQUIRE(result["qty"].equals(std::vector<int64_t>{ 4, 8 }));
+    }
+
+    SECTION("filters reach the parquet scan")
+    {
+        auto path = std::filesystem::temp_directory_path() / "lazy_test.parquet";
+        df.toParquet(path);
+
+        auto plan = pd::LazyFrame::scanParquet(path)
+                        .select({ "key", "qty" })
+                        .where("key == 2");
+        auto explained = plan.explain();
+        REQUIRE(explained.find("Filter") == std::string::npos);
+        REQUIRE(explained.find("columns=[key, qty]") != std::string::npos);
+
+        auto result = plan.collect();
+        REQUIRE(result["qty"].equals(std::vector<int64_t>{ 2, 4 }));
+        REQUIRE(result.indexArray()->Equals(arrow::ArrayT<int64_t>::Make({ 20, 40 })));
+    }
+}
+
+TEST_CASE("Test LazyFrame group_by over several batches", "[Lazy]")
+{
+    // more rows than one source batch, with keys first seen in later batches
+    int64_t rows = 2 * (1 << 20) + 7;
+    std::vector<int64_t> keys(rows), qty(rows);
+    for (int64_t i = 0; i < rows; ++i)
+    {
+        keys[i] = (i / 4096) * 7919 % 1031;
+        qty[i] = i % 13;
+    }
+    pd::DataFrame df(std::map<std::string, std::vector<int64_t>>{
+        { "key", keys }, { "qty", qty } });
+
+    auto eager = pd::ReturnOrThrowOnFailure(
+        df.group_by("key").agg({ { "qty", { "sum" } } }));
+    for (int run = 0; run < 3; ++run)
+    {
+        auto lazy = df.lazy().group_by({ "key" }, { { "qty", "sum" } }).collect();
+        REQUIRE(lazy["key"].m_array->Equals(eager.indexArray()));
+        REQUIRE(lazy["qty"].m_array->Equals(eager["qty"].m_array));
+    }
+}
@@ -5,6 +5,7 @@
 #include <rapidjson/document.h>
 #include "pandas_arrow.h"
 #include "stdexcept"
+#include <numeric>
 
 bool operator==(std::shared_ptr<arrow::DataType> const& a,
                 std::shared_ptr<arrow::DataType> const& b)
@@ -599,6 +600,60 @@ TEST_CASE("Test Series::index() function") {
 
 }
 
+TEST_CASE("Test typed Indexer", "[indexer]") {
+    SECTION("integer labels, last duplicate wins")
+    {
+        pd::Indexer indexer(arrow::ArrayT<int>::Make({ 5, 7, 9, 7 }));
+        REQUIRE(indexer.size() == 3);
+        REQUIRE(indexer.find(arrow::Int32Scalar(5)) == 0);
+        REQUIRE(indexer.find(arrow::Int32Scalar(7)) == 3);
+        REQUIRE(indexer.find(arrow::Int32Scalar(8)) == -1);
+        REQUIRE(indexer.positions() == std::vector<int64_t>{ 0, 2, 3 });
+
+        // labels are cast to the index type
+        REQUIRE(indexer.find(arrow::Int64Scalar(9)) == 2);
+        REQUIRE(indexer.find(arrow::DoubleScalar(5.0)) == 0);
+        REQUIRE_THROWS_AS(
+            indexer.at(arrow::MakeScalar(int64_t{ 1 })),
+            std::out_of_range);
+
+        auto rows = indexer.find(*arrow::ArrayT<int64_t>::Make({ 9, 1, 5 }));
+        REQUIRE(rows == std::vector<int64_t>{ 2, -1, 0 });
+    }
+
+    SECTION("string labels")
+    {
+        pd::Indexer indexer(
+            arrow::ArrayT<std::string>::Make({ "a", "bb", "ccc" }));
+        REQUIRE(indexer.find(arrow::StringScalar("bb")) == 1);
+        REQUIRE(indexer.find(arrow::StringScalar("d")) == -1);
+    }
+
+    SECTION("timestamp labels")
+    {
+        arrow::TimestampBuilder builder(
+            arrow::timestamp(arrow::TimeUnit::NANO),
+            arrow::default_memory_pool());
+        REQUIRE(builder.AppendValues({ 100, 200, 300 }).ok());
+        pd::Indexer indexer(builder.Finish().MoveValueUnsafe());
+
+        arrow::TimestampScalar label(300, arrow::TimeUnit::NANO);
+        REQUIRE(indexer.find(label) == 2);
+        REQUIRE(indexer.find(*arrow::MakeArrayFromScalar(label, 2)
+                                  .MoveValueUnsafe()) ==
+                std::vector<int64_t>{ 2, 2 });
+    }
+
+    SECTION("large index")
+    {
+        std::vector<int64_t> values(1 << 18);
+        std::iota(values.begin(), values.end(), 0);
+        pd::Indexer indexer(arrow::ArrayT<int64_t>::Make(values));
+        REQUIRE(indexer.size() == values.size());
+        REQUIRE(indexer.find(arrow::Int64Scalar(123456)) == 123456);
+    }
+}
+
 TEST_CASE("Test Series::count() function") {
     std::vector<int> vec1 = {1, 2, 3, 4, 5};
     auto array1 = arrow::ArrayT<int>::Make(vec1);
@@ -1998,6 +2053,78 @@ TEST_CASE("Test reindex vs reindex_async benchamark big data", "[reindex]")
     std::cout << std::chrono::duration<double>(end-start).count() << " s.\n";
 }
 
+TEST_CASE("Test morsel parallel binary operators", "[parallel]")
+{
+    int64_t n = 5 * pd::PD_MORSEL_SIZE + 123;
+    std::vector<int64_t> a(n), b(n);
+    std::vector<bool> valid(n);
+    for (int64_t i = 0; i < n; i++)
+    {
+        a[i] = i;
+        b[i] = 2 * i;
+        valid[i] = i % 7 != 0;
+    }
+
+    pd::Series x{ arrow::ArrayT<int64_t>::Make(a, valid), nullptr };
+    pd::Series y{ arrow::ArrayT<int64_t>::Make(b), nullptr };
+
+    auto expected = pd::ReturnOrThrowOnFailure(
+        arrow::compute::CallFunction("add", { x.array(), y.array() }));
+    REQUIRE((x + y).array()->Equals(expected.make_array()));
+
+    auto scaled = x * pd::Scalar(int64_t{ 3 });
+    REQUIRE(scaled.array()->null_count() == x.array()->null_count());
+    REQUIRE(scaled.array()->Equals(pd::ReturnOrThrowOnFailure(
+        arrow::compute::CallFunction(
+            "multiply", { x.array(), arrow::MakeScalar(int64_t{ 3 }) }))
+        .make_array()));
+
+    // boolean output, and a sliced input
+    auto sliced = pd::Series{ x.array()->Slice(3), nullptr };
+    auto shifted = pd::Series{ y.array()->Slice(0, n - 3), nullptr };
+    REQUIRE((sliced < shifted).array()->Equals(pd::ReturnOrThrowOnFailure(
+        arrow::compute::CallFunction("less", { sliced.array(), shifted.array() }))
+        .make_array()));
+}
+
+TEST_CASE("Test compound assignment operators", "[parallel]")
+{
+    int64_t n = 3 * pd::PD_MORSEL_SIZE + 5;
+    std::vector<int64_t> a(n), b(n);
+    std::vector<bool> valid(n);
+    for (int64_t i = 0; i < n; i++)
+    {
+        a[i] = i;
+        b[i] = n - i;
+        valid[i] = i % 5 != 0;
+    }
+
+    pd::Series x{ arrow::ArrayT<int64_t>::Make(a), nullptr };
+    pd::Series y{ arrow::ArrayT<int64_t>::Make(b, valid), nullptr };
+    auto values = x.array()->data()->buffers[1]->data();
+
+    auto sum = (x + y).array();
+    x += y;
+    REQUIRE(x.array()->data()->buffers[1]->data() == values);
+    REQUIRE(x.array()->Equals(sum));
+
+    auto doubled = (x * pd::Scalar(int64_t{ 2 })).array();
+    x *= pd::Scalar(int64_t{ 2 });
+    REQUIRE(x.array()->data()->buffers[1]->data() == values);
+    REQUIRE(x.array()->Equals(doubled));
+
+    // a copy shares the buffers, so the update copies on write
+    auto copy = x;
+    x -= pd::Scalar(int64_t{ 1 });
+    REQUIRE(x.array()->data()->buffers[1]->data() != values);
+    REQUIRE(copy.array()->Equals(doubled));
+    REQUIRE(x.array()->Equals((copy - pd::Scalar(int64_t{ 1 })).array()));
+
+    // a different result type replaces the array
+    x /= pd::Scalar(2.0);
+    REQUIRE(x.array()->type()->Equals(arrow::float64()));
+}
+
 TEST_CASE("Test reindex function", "[reindex]")
 {
     // Create a test input Series
@@ -2019,6 +2146,20 @@ TEST_CASE("Test reindex function", "[reindex]")
     REQUIRE(outputSeries.array()->Equals(expectedValues));
 }
 
+TEST_CASE("Test reindex with a string index", "[reindex]")
+{
+    auto inputData = arrow::ArrayT<double>::Make({1.5, 2.5, 3.5});
+    auto inputIndex = arrow::ArrayT<std::string>::Make({"a", "b", "c"});
+    pd::Series inputSeries(inputData, inputIndex);
+
+    auto newIndex = arrow::ArrayT<std::string>::Make({"c", "x", "a", "a"});
+    auto expectedValues =
+        arrow::ArrayT<double>::Make({3.5, 0, 1.5, 1.5}, {true, false, true, true});
+
+    REQUIRE(inputSeries.reindex(newIndex).array()->Equals(expectedValues));
+    REQUIRE(inputSeries.reindexAsync(newIndex).array()->Equals(expectedValues));
+}
+
 TEST_CASE("Test resample on series", "[Resample]")
 {
     auto index = pd::date_range(ptime(date(2000, 1, 1)), 9);